@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+constexpr size_t ARENA_FIRST_BLOCK_BYTES = 64 * 1024;
+
+// Bump allocator for scratch data that dies together
+// Only matchPoints uses it: the join's time buckets, completion index,
+// date set and candidate list. Batch runs give each join a local arena;
+// watch mode keeps one in the session and releases it before each refresh.
+// Allocating is a pointer bump and freeing a single object does nothing.
+// release() hands every block back to the upstream resource (the heap),
+// so the next join allocates fresh blocks. Not thread safe; one per thread.
+struct Arena
+{
+    explicit Arena(size_t firstBlockBytes = ARENA_FIRST_BLOCK_BYTES)
+        : pool(firstBlockBytes)
+    {
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &pool; }
+
+    // Everything allocated so far is gone; containers using it must be dead
+    void release() { pool.release(); }
+
+private:
+    std::pmr::monotonic_buffer_resource pool;
+};
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "Benchmark.h"
+#include "ComputeFunctions.h"
+#include "InputFunctions.h"
+#include "LayoutStats.h"
+#include "PointsLoader.h"
+#include "PrintFunctions.h"
+
+constexpr int BENCH_REPEATS = 15;                   // Timed samples per stage, after one warm-up run
+constexpr double BENCH_MIN_SAMPLE_MS = 20.0;        // Faster stages repeat inside a sample until it takes this long
+constexpr double BENCH_REGRESSION_TOLERANCE = 0.10; // A regression must be at least this much slower...
+constexpr double BENCH_NOISE_SIGMAS = 4.0;          // ...and this many noise sigmas (both runs' spread combined)...
+constexpr double BENCH_MIN_REGRESSION_MS = 0.05;    // ...and this many milliseconds
+constexpr const char* BENCH_BASELINE_FILE = "bench_baseline.txt";
+
+// Median of the samples and their spread (MAD scaled to a standard deviation)
+struct BenchTiming
+{
+    double ms = 0.0;
+    double spread = 0.0;
+};
+
+struct BenchResult
+{
+    std::string name;
+    BenchTiming time;
+    double work;        // Units processed per run, for the throughput column
+    const char* unit;
+};
+
+static double median(std::vector<double> v)
+{
+    const size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    if (v.size() % 2)
+        return v[mid];
+    return (v[mid] + *std::max_element(v.begin(), v.begin() + mid)) / 2.0;
+}
+
+template <typename Fn>
+static BenchTiming measureMs(Fn&& fn)
+{
+    auto timeRuns = [&](int runs) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < runs; ++k)
+            fn();
+        const auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(t1 - t0).count() / runs;
+    };
+
+    // The warm-up run also sizes the batch, so timer resolution does not
+    // dominate sub-millisecond stages
+    const double warm = timeRuns(1);
+    const int runs = (warm >= BENCH_MIN_SAMPLE_MS) ? 1
+        : static_cast<int>(std::min(1000.0, std::ceil(BENCH_MIN_SAMPLE_MS / std::max(warm, 0.001))));
+
+    std::vector<double> samples(BENCH_REPEATS);
+    for (auto& sample : samples)
+        sample = timeRuns(runs);
+
+    BenchTiming t;
+    t.ms = median(samples);
+    for (auto& sample : samples)
+        sample = std::abs(sample - t.ms);
+    t.spread = 1.4826 * median(samples);
+    return t;
+}
+
+// Slower by more than the relative tolerance, the combined noise and the floor
+static bool isRegression(const BenchTiming& now, const BenchTiming& base)
+{
+    const double limit = std::max({
+        BENCH_REGRESSION_TOLERANCE * base.ms,
+        BENCH_NOISE_SIGMAS * std::hypot(now.spread, base.spread),
+        BENCH_MIN_REGRESSION_MS });
+    return now.ms - base.ms > limit;
+}
+
+// "name ms spread" per line; older files without the spread read it as 0
+static std::map<std::string, BenchTiming> loadBaseline(const std::filesystem::path& path)
+{
+    std::map<std::string, BenchTiming> baseline;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        std::string name;
+        BenchTiming t;
+        if (fields >> name >> t.ms)
+        {
+            if (!(fields >> t.spread))
+                t.spread = 0.0;
+            baseline[name] = t;
+        }
+    }
+    return baseline;
+}
+
+static bool saveBaselineFile(const std::filesystem::path& path, const std::vector<BenchResult>& results)
+{
+    TextBuffer out;
+    for (const auto& r : results)
+        out.put(r.name).put(' ').fixed(r.time.ms, 3).put(' ').fixed(r.time.spread, 3).put('\n');
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(out.data.data(), static_cast<std::streamsize>(out.data.size()));
+    return static_cast<bool>(file);
+}
+
+// Everything the report tables need, computed up front so the render
+// stage only times formatting
+struct RenderInputs
+{
+    PointsToPrint points;
+    PointsToPrint pph;
+    std::map<std::string, int> recent;
+    std::vector<std::pair<std::string, const Stats*>> common;
+    RoomDistribution rd;
+    DiscardedOutliers discarded;      // Refers into the stats passed alongside
+    std::vector<RoomPPHResult> roomPPH;
+    LayoutAnalysis layouts;
+    std::vector<RoomPercentiles> percentiles;
+    std::vector<int> lastNs;
+    std::vector<std::map<std::string, double>> lastNAvgs;
+    int raids;
+};
+
+static RenderInputs prepareRender(const RaidTable& table, const WindowIndex& windows, const std::map<std::string, Stats>& stats)
+{
+    RenderInputs in;
+    const auto agg = computePointsStats(table);
+    in.points = makePointsToPrint(agg.bestPoints, agg.avgPoints, table.totalPoints.back());
+    in.pph = makePointsToPrint(agg.bestPPH, agg.avgPPH, agg.recentPPH);
+    in.recent = computeRecentRaidTimes(table);
+    in.common = computeMostCommonRooms(stats);
+    in.rd = computeRoomDistribution(table);
+    in.discarded = collectDiscarded(stats);
+    in.roomPPH = computeRoomPPH(table);
+    in.layouts = computeLayoutAnalysis(table);
+    in.percentiles = computeRoomPercentiles(stats);
+    in.lastNs = { 10 };
+    in.lastNAvgs = { computeLastNStats(windows, 10) };
+    in.raids = static_cast<int>(table.size());
+    return in;
+}
+
+// The primary-only report, minus the join summary
+static void renderReport(TextBuffer& out, const std::string& user, const std::map<std::string, Stats>& stats, const RenderInputs& in)
+{
+    const std::map<std::string, Stats> noStats;
+    const int totalWidth = computeTotalWidth(false, static_cast<int>(in.lastNs.size()));
+
+    out.data.clear();
+    printRaidStatisticsHeader(out, user, "", false, totalWidth, in.lastNs);
+    printStatsTable(out, stats, noStats, in.recent, "", totalWidth, false, in.pph, in.points, in.lastNAvgs);
+    printPercentileTable(out, in.percentiles);
+    printRoomPPHTable(out, in.roomPPH);
+    printMostCommonPrepRooms(out, in.common, in.rd.five, in.rd.six, in.rd.other, in.raids);
+    printLayoutTables(out, in.layouts, 10);
+    printDiscardedOutliers(out, in.discarded, user, "Primary");
+}
+
+int runBenchmarks(const std::string& directory, bool saveBaseline)
+{
+    const std::filesystem::path dir(directory);
+    const std::string coxPath = (dir / "Synthetic_CoxTimes.txt").string();
+    const std::string trackerPath = (dir / "raid_tracker_data.log").string();
+
+    std::error_code ec;
+    const auto coxBytes = std::filesystem::file_size(coxPath, ec);
+    const auto trackerBytes = ec ? 0 : std::filesystem::file_size(trackerPath, ec);
+    if (ec)
+    {
+        std::cerr << "No synthetic logs in " << directory << " (run --generate first)\n";
+        return -1;
+    }
+    const double coxMB = coxBytes / (1024.0 * 1024.0);
+    const double trackerMB = trackerBytes / (1024.0 * 1024.0);
+
+    std::vector<BenchResult> results;
+    std::vector<Raid> raids;
+    std::vector<PrimaryRaid> keys;
+    std::vector<PointsRaid> points;
+    std::map<int, int> pointsMap;
+
+    results.push_back({ "readRaids", measureMs([&] {
+        readRaids(coxPath, raids, ParserMode::Mapped, &keys);
+        }), coxMB, "MB/s" });
+    if (raids.empty())
+    {
+        std::cerr << "No raids in " << coxPath << "\n";
+        return -1;
+    }
+
+    results.push_back({ "loadPointsFile", measureMs([&] {
+        points = loadPointsFile(trackerPath);
+        }), trackerMB, "MB/s" });
+
+    results.push_back({ "loadPoints", measureMs([&] {
+        pointsMap = loadPoints(keys, trackerPath);
+        }), static_cast<double>(keys.size()), "raids/s" });
+
+    // Same preparation as the report before aggregating
+    attachPointsToRaids(raids, pointsMap);
+    filterRaidsWithPoints(raids);
+    finalizeDerivedRaidTimes(raids);
+    const RaidTable table = buildRaidTable(raids);
+    const WindowIndex windows = buildWindowIndex(table);
+    const double rows = static_cast<double>(table.size());
+
+    std::map<std::string, Stats> stats;
+    results.push_back({ "aggregateStats", measureMs([&] {
+        stats = initializeStats();
+        aggregateStats(stats, table);
+        }), rows, "raids/s" });
+
+    std::vector<RoomPPHResult> roomPPH;
+    results.push_back({ "computeRoomPPH", measureMs([&] {
+        roomPPH = computeRoomPPH(table);
+        }), rows, "raids/s" });
+
+    LayoutAnalysis layouts;
+    results.push_back({ "layoutAnalysis", measureMs([&] {
+        layouts = computeLayoutAnalysis(table);
+        }), rows, "raids/s" });
+
+    const RenderInputs render = prepareRender(table, windows, stats);
+    TextBuffer report;
+    results.push_back({ "render", measureMs([&] {
+        renderReport(report, "Synthetic", stats, render);
+        }), 1.0, "reports/s" });
+
+    // ======================== OUTPUT ===========================
+    const std::filesystem::path baselinePath = dir / BENCH_BASELINE_FILE;
+    const bool haveBaseline = std::filesystem::exists(baselinePath, ec);
+    const auto baseline = haveBaseline ? loadBaseline(baselinePath) : std::map<std::string, BenchTiming>{};
+
+    constexpr int NAME_W = 18;
+    constexpr int COL_W = 14;
+    constexpr int TOTAL_W = NAME_W + 5 * COL_W + 12;
+
+    TextBuffer out;
+    out.put("Benchmark - ").put(static_cast<int>(keys.size())).put(" solo raids (")
+        .put(static_cast<int>(table.size())).put(" with points), ")
+        .fixed(coxMB, 1).put(" MB CoxTimes, ").fixed(trackerMB, 1).put(" MB tracker log (median of ")
+        .put(BENCH_REPEATS).put(")\n");
+    out.repeat('=', TOTAL_W).put('\n');
+    out.left("Stage", NAME_W).right("Median ms", COL_W).right("Noise ms", COL_W).right("Throughput", COL_W).repeat(' ', 10)
+        .right("Baseline ms", COL_W).right("Change", COL_W).put('\n');
+    out.repeat('-', TOTAL_W).put('\n');
+
+    int regressions = 0;
+    for (const auto& r : results)
+    {
+        out.left(r.name, NAME_W)
+            .rightFixed(r.time.ms, 3, COL_W)
+            .rightFixed(r.time.spread, 3, COL_W)
+            .rightFixed(r.time.ms > 0 ? r.work * 1000.0 / r.time.ms : 0.0, 1, COL_W)
+            .put(' ').left(r.unit, 9);
+
+        auto it = baseline.find(r.name);
+        if (it == baseline.end() || it->second.ms <= 0)
+        {
+            out.right("-", COL_W).right("-", COL_W).put('\n');
+            continue;
+        }
+
+        const double change = (r.time.ms - it->second.ms) / it->second.ms;
+        const bool regressed = isRegression(r.time, it->second);
+        regressions += regressed;
+
+        char pct[32];
+        auto end = std::to_chars(pct, pct + sizeof(pct), change * 100.0, std::chars_format::fixed, 1).ptr;
+        *end++ = '%';
+        const std::string_view pctText(pct, static_cast<size_t>(end - pct));
+
+        out.rightFixed(it->second.ms, 3, COL_W);
+        if (change >= 0)
+            out.repeat(' ', COL_W - 1 - static_cast<int>(pctText.size())).put('+').put(pctText);
+        else
+            out.right(pctText, COL_W);
+        if (regressed)
+            out.put("  ").put(COLOR_RED).put("REGRESSION").put(COLOR_RESET);
+        out.put('\n');
+    }
+    out.repeat('=', TOTAL_W).put('\n');
+
+    if (!haveBaseline || saveBaseline)
+    {
+        if (saveBaselineFile(baselinePath, results))
+            out.put("Baseline written to ").put(baselinePath.string()).put('\n');
+        else
+            out.put("Cannot write ").put(baselinePath.string()).put('\n');
+    }
+    else if (regressions > 0)
+    {
+        out.put(regressions).put(" stage(s) slower than the baseline by more than ")
+            .fixed(BENCH_REGRESSION_TOLERANCE * 100.0, 0).put("% and ")
+            .fixed(BENCH_NOISE_SIGMAS, 0).put(" noise sigmas\n");
+    }
+    out.flush();
+
+    return regressions;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+// Times the pipeline stages (readRaids, loadPointsFile, loadPoints,
+// aggregateStats, computeRoomPPH, rendering) on the logs generateSyntheticLogs
+// wrote to directory: the median of several runs each, with its spread.
+// Results are compared with <dir>/bench_baseline.txt, which is written when
+// missing or when saveBaseline is set. A stage only counts as slower when the
+// change beats a relative tolerance, the measured noise and an absolute floor.
+// Returns the number of such stages, -1 if the logs could not be read
+int runBenchmarks(const std::string& directory, bool saveBaseline);
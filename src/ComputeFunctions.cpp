@@ -1,81 +1,120 @@
-﻿#include <iomanip>
-#include <sstream>
-#include <algorithm>
+﻿#include <algorithm>
 #include <climits>
+#include <bit>
+#include <cmath>
+#include <optional>
 
 #include "ComputeFunctions.h"
 #include "PrintFunctions.h"
 
 std::string secondsToTime(int seconds)
 {
-    if (seconds <= 0) return "00:00";
-    int m = seconds / 60;
-    int s = seconds % 60;
-    std::ostringstream oss;
-    oss << std::setw(2) << std::setfill('0') << m << ":"
-        << std::setw(2) << std::setfill('0') << s;
-    return oss.str();
+    char buf[16];
+    return std::string(buf, formatTime(buf, seconds));
 }
 
-void processStats(std::map<std::string, Stats>& stats, const std::string& key, const std::vector<Raid>& raids, size_t start)
+RaidTable buildRaidTable(const std::vector<Raid>& raids)
 {
-    auto& s = stats[key];
-
-    double sum = 0.0;
-    int best = INT_MAX;
+    RaidTable table;
+    appendRaidTable(table, raids, 0);
+    return table;
+}
 
-    const bool hasMinRef = ROOM_REFERENCE_FOR_OUTLIERS.count(key);
-    const bool hasMaxRef = ROOM_MAX_REFERENCE.count(key);
+void appendRaidTable(RaidTable& table, const std::vector<Raid>& raids, size_t from)
+{
+    const size_t base = table.size();
+    const size_t n = base + (raids.size() - std::min(from, raids.size()));
 
-    const int minRef = hasMinRef ? ROOM_REFERENCE_FOR_OUTLIERS.at(key) : 0;
-    const int maxRef = hasMaxRef ? ROOM_MAX_REFERENCE.at(key) : INT_MAX;
+    table.kc.resize(n);
+    table.totalSeconds.resize(n);
+    table.totalPoints.resize(n);
+    table.layout.resize(n);
+    for (auto& col : table.times)
+        col.resize(n, 0);
 
-    for (size_t i = start; i < raids.size(); ++i)
+    for (size_t i = base; i < n; ++i)
     {
-        const auto& r = raids[i];
-        auto it = r.times.find(key);
-        if (it == r.times.end())
-            continue;
+        const auto& r = raids[from + (i - base)];
+        table.kc[i] = r.kc;
+        table.totalSeconds[i] = r.totalSeconds;
+        table.totalPoints[i] = r.totalPoints;
+        table.layout[i] = r.present;
+
+        for (size_t room = 0; room < ROOM_COUNT; ++room)
+            if (r.present & (1u << room))
+                table.times[room][i] = r.times[room];
+    }
+}
 
-        int t = it->second;
-        bool valid = true;
-        std::string reason;
+// Adaptive outliers use the modified z-score: |t - median| / (1.4826 * MAD) > 3.5
+constexpr double ADAPTIVE_Z_LIMIT = 3.5;
+constexpr double MAD_TO_SIGMA = 1.4826;
+constexpr double MIN_SIGMA_SECONDS = 2.0;   // Keeps near-constant rooms from flagging every second
+constexpr size_t ADAPTIVE_WARMUP = 15;      // Samples before the window replaces the fixed limits
 
-        // --- too short ---
-        if (t < 20)
-        {
-            valid = false;
-            reason = "<20s";
-        }
-        else if (hasMinRef && t < minRef)
-        {
-            valid = false;
-            reason = "below min";
-        }
-        // --- too long ---
-        else if (hasMaxRef && t > maxRef)
-        {
-            valid = false;
-            reason = "above max";
-        }
+// std::nullopt for a valid sample, otherwise the discard reason
+static std::optional<OutlierReason> outlierReason(int t, const RoomInfo& lim)
+{
+    // --- too short ---
+    if (t < 20)
+        return OutlierReason::TooShort;
+    if (lim.minSeconds > 0 && t < lim.minSeconds)
+        return OutlierReason::BelowMin;
+    // --- too long ---
+    if (lim.maxSeconds > 0 && t > lim.maxSeconds)
+        return OutlierReason::AboveMax;
+    return std::nullopt;
+}
 
-        if (!valid)
-        {
-            s.discarded.emplace_back(r.kc, key, t, reason);
-            continue;
-        }
+// Same reasons, judged against this player's recent times for the room
+// Fixed limits apply until the window has warmed up
+static std::optional<OutlierReason> adaptiveOutlierReason(int t, const RoomInfo& lim, const RollingMedian& recent)
+{
+    if (t < 20)
+        return OutlierReason::TooShort;
+    if (recent.size() < ADAPTIVE_WARMUP)
+        return outlierReason(t, lim);
+
+    const double median = recent.median();
+    const double sigma = std::max(MAD_TO_SIGMA * recent.mad(), MIN_SIGMA_SECONDS);
+    if (std::abs(t - median) <= ADAPTIVE_Z_LIMIT * sigma)
+        return std::nullopt;
+    return (t < median) ? OutlierReason::BelowMin : OutlierReason::AboveMax;
+}
 
-        // valid entry
-        s.entries.push_back({ r.kc, t });
-        sum += t;
-        best = std::min(best, t);
-        ++s.validCount;
-    }
+static void addSample(Stats& st, Room room, int kc, int t, const RoomInfo& lim, OutlierMode mode)
+{
+    const std::optional<OutlierReason> reason = (mode == OutlierMode::Adaptive)
+        ? adaptiveOutlierReason(t, lim, st.recent)
+        : outlierReason(t, lim);
+
+    // Flagged times still enter the window so a real change in pace is
+    // picked up; median and MAD shrug off the odd bad sample
+    if (mode == OutlierMode::Adaptive && t >= 20)
+        st.recent.push(t);
+
+    if (reason)
+        st.addDiscarded({ kc, t, room, *reason });
+    else
+        st.push(t);
+}
+
+void processStats(std::map<std::string, Stats>& stats, const std::string& key, const RaidTable& table, size_t start,
+    OutlierMode mode)
+{
+    auto it = stats.try_emplace(key).first;
+    const Room room = roomFromName(key);
+    if (room == Room::Count)
+        return;
+
+    const auto& lim = roomInfo(room);
+    const uint32_t bit = roomBit(room);
+    const int32_t* col = table.column(room).data();
 
-    if (s.validCount > 0)
+    for (size_t i = start; i < table.size(); ++i)
     {
-        s.avg = sum / s.validCount;
-        s.fastest = best;
+        if (table.layout[i] & bit)
+            addSample(it->second, room, table.kc[i], col[i], lim, mode);
     }
 }
 
@@ -88,34 +127,71 @@ std::map<std::string, Stats> initializeStats()
 	return stats;
 }
 
-void aggregateStats(std::map<std::string, Stats>& stats, const std::vector<Raid>& raids, size_t start)
+StatsStream::StatsStream(std::map<std::string, Stats>& stats, OutlierMode mode)
+    : mode(mode)
 {
-    for (const auto& k : DISPLAY_ORDER) {
-        processStats(stats, k, raids, start);
+    for (size_t room = 0; room < DISPLAY_ROOM_COUNT; ++room)
+    {
+        auto it = stats.try_emplace(std::string(ROOM_NAMES[room])).first;
+        out[room] = &it->second;
     }
 }
 
-std::map<std::string, int> computeRecentRaidTimes(const std::vector<Raid>& raids)
+void StatsStream::add(size_t room, int kc, int t)
+{
+    addSample(*out[room], static_cast<Room>(room), kc, t, ROOM_INFO[room], mode);
+}
+
+void StatsStream::push(const Raid& raid)
+{
+    uint32_t layout = raid.present & DISPLAY_ROOM_MASK;
+    while (layout)
+    {
+        const size_t room = std::countr_zero(layout);
+        layout &= layout - 1;
+        add(room, raid.kc, raid.times[room]);
+    }
+}
+
+void StatsStream::push(const RaidTable& table, size_t row)
+{
+    uint32_t layout = table.layout[row] & DISPLAY_ROOM_MASK;
+    while (layout)
+    {
+        const size_t room = std::countr_zero(layout);
+        layout &= layout - 1;
+        add(room, table.kc[row], table.times[room][row]);
+    }
+}
+
+// Single pass over the raids: each row updates every room it contains
+// Gives the same Stats as running processStats per DISPLAY_ORDER key
+void aggregateStats(std::map<std::string, Stats>& stats, const RaidTable& table, size_t start, OutlierMode mode)
+{
+    StatsStream stream(stats, mode);
+    for (size_t i = start; i < table.size(); ++i)
+        stream.push(table, i);
+}
+
+std::map<std::string, int> computeRecentRaidTimes(const RaidTable& table)
 {
     std::map<std::string, int> recentVal;
-    const auto& rr = raids.back();
+    const size_t last = table.size() - 1;
+    const uint32_t layout = table.layout[last];
 
-    for (const auto& [k, v] : rr.times)
-        recentVal[k] = v;
+    for (size_t i = 0; i < ROOM_COUNT; ++i)
+        if (layout & (1u << i))
+            recentVal[std::string(ROOM_NAMES[i])] = table.times[i][last];
 
     return recentVal;
 }
 
-RoomDistribution computeRoomDistribution(const std::vector<Raid>& raids)
+RoomDistribution computeRoomDistribution(const RaidTable& table)
 {
     RoomDistribution rd;
 
-    for (size_t i = 0; i < raids.size(); ++i) {
-        const auto& r = raids[i];
-        int count = 0;
-        for (const auto& room : PREP_ROOMS) {
-            if (r.times.count(room)) ++count;
-        }
+    for (size_t i = 0; i < table.size(); ++i) {
+        int count = std::popcount(prepMask(table.layout[i]));
         if (count == 5) ++rd.five;
         else if (count == 6) ++rd.six;
         else ++rd.other;
@@ -134,17 +210,17 @@ int computeCountPad(const std::map<std::string, Stats>& stats)
     return (maxPrepCount == 0) ? 1 : static_cast<int>(std::to_string(maxPrepCount).length());
 }
 
-std::vector<std::tuple<int, std::string, int, std::string>> collectAndSortDiscarded(const std::map<std::string, Stats>& stats)
+DiscardedOutliers collectDiscarded(const std::map<std::string, Stats>& stats)
 {
-	std::vector<std::tuple<int, std::string, int, std::string>> discarded;
-
+    DiscardedOutliers out;
     for (const auto& pair : stats) {
-        const auto& st = pair.second;
-        for (const auto& d : st.discarded) discarded.push_back(d);
+        const auto& log = pair.second.discarded;
+        if (log.empty())
+            continue;
+        out.runs.push_back({ log.data(), log.data() + log.size() });
+        out.total += log.size();
     }
-
-    std::sort(discarded.rbegin(), discarded.rend());
-    return discarded;
+    return out;
 }
 
 std::vector<std::pair<std::string, const Stats*>> computeMostCommonRooms(const std::map<std::string, Stats>& stats)
@@ -162,11 +238,11 @@ std::vector<std::pair<std::string, const Stats*>> computeMostCommonRooms(const s
     return common;
 }
 
-int computeTotalWidth(bool hasSecondary)
+int computeTotalWidth(bool hasSecondary, int lastNColumns)
 {
-    const int columnCount = hasSecondary ? 6 : 5;
+    const int columnCount = (hasSecondary ? 5 : 4) + lastNColumns;
     const int totalCols =
-        NW + TW + AW + RW + LW +
+        NW + TW + AW + RW + LW * lastNColumns +
         (hasSecondary ? CW : 0);
 
     return totalCols + (columnCount - 1) * SEP;
@@ -212,7 +288,7 @@ void keepMostRecentRaids(std::vector<Raid>& raids, int maxCount)
 
 
 
-PointsAggregate computePointsStats(const std::vector<Raid>& raids)
+PointsAggregate computePointsStats(const RaidTable& table)
 {
     PointsAggregate out;
 
@@ -221,18 +297,21 @@ PointsAggregate computePointsStats(const std::vector<Raid>& raids)
     int countPPH = 0;
     int countPoints = 0;
 
-    for (const auto& r : raids)
+    const int32_t* points = table.totalPoints.data();
+    const int32_t* seconds = table.totalSeconds.data();
+
+    for (size_t i = 0; i < table.size(); ++i)
     {
-        if (r.totalPoints > 0)
+        if (points[i] > 0)
         {
-            sumPoints += r.totalPoints;
+            sumPoints += points[i];
             ++countPoints;
-            out.bestPoints = std::max(out.bestPoints, r.totalPoints);
+            out.bestPoints = std::max(out.bestPoints, points[i]);
         }
 
-        if (r.totalPoints > 0 && r.totalSeconds > 0)
+        if (points[i] > 0 && seconds[i] > 0)
         {
-            double pph = r.totalPoints / (r.totalSeconds / 3600.0);
+            double pph = points[i] / (seconds[i] / 3600.0);
             sumPPH += pph;
             ++countPPH;
             out.bestPPH = std::max(out.bestPPH, static_cast<int>(pph));
@@ -246,11 +325,12 @@ PointsAggregate computePointsStats(const std::vector<Raid>& raids)
         out.avgPPH = static_cast<int>(sumPPH / countPPH);
 
     // recent
-    if (!raids.empty())
+    if (!table.empty())
     {
-        const auto& r = raids.back();
-        if (r.totalPoints > 0 && r.totalSeconds > 0)
-            out.recentPPH = static_cast<int>(r.totalPoints / (r.totalSeconds / 3600.0));
+        const int p = table.totalPoints.back();
+        const int t = table.totalSeconds.back();
+        if (p > 0 && t > 0)
+            out.recentPPH = static_cast<int>(p / (t / 3600.0));
     }
 
     return out;
@@ -266,35 +346,41 @@ PointsToPrint makePointsToPrint(int best, int average, int recent)
     return p;
 }
 
-std::vector<RoomPPHResult> computeRoomPPH(const std::vector<Raid>& raids)
+std::vector<RoomPPHResult> computeRoomPPH(const RaidTable& table)
 {
-    std::map<std::string, RoomPPHStats> acc;
+    std::array<RoomPPHStats, PREP_ROOM_COUNT> acc{};
 
-    for (const auto& r : raids)
+    const int32_t* points = table.totalPoints.data();
+    const int32_t* seconds = table.totalSeconds.data();
+
+    // One pass per room column; prep times are only stored when > 0,
+    // so a zero cell means the room was not in that raid
+    for (size_t room = 0; room < PREP_ROOM_COUNT; ++room)
     {
-        if (r.totalPoints <= 0 || r.totalSeconds <= 0)
-            continue;
+        const int32_t* col = table.times[room].data();
+        auto& a = acc[room];
 
-        for (const auto& room : PREP_ROOMS)
+        for (size_t i = 0; i < table.size(); ++i)
         {
-            auto it = r.times.find(room);
-            if (it == r.times.end())
+            const int t = col[i];
+            if (t <= 0 || points[i] <= 0 || seconds[i] <= 0)
                 continue;
 
-            acc[room].raids++;
-            double share = static_cast<double>(it->second) / r.totalSeconds;
-            acc[room].totalPoints += r.totalPoints * share;
+            a.raids++;
+            double share = static_cast<double>(t) / seconds[i];
+            a.totalPoints += points[i] * share;
 
-            acc[room].totalSeconds += it->second;
+            a.totalSeconds += t;
         }
     }
 
     std::vector<RoomPPHResult> result;
     result.reserve(acc.size());
 
-    for (const auto& [room, stats] : acc)
+    for (size_t i = 0; i < PREP_ROOM_COUNT; ++i)
     {
-        if (stats.totalSeconds <= 0)
+        const auto& stats = acc[i];
+        if (stats.raids == 0 || stats.totalSeconds <= 0)
             continue;
 
         int avgPPH = static_cast<int>(
@@ -302,7 +388,7 @@ std::vector<RoomPPHResult> computeRoomPPH(const std::vector<Raid>& raids)
             );
 
         result.push_back({
-            room,
+            std::string(ROOM_NAMES[i]),
             avgPPH,
             stats.raids
             });
@@ -311,131 +397,229 @@ std::vector<RoomPPHResult> computeRoomPPH(const std::vector<Raid>& raids)
     std::sort(result.begin(), result.end(),
         [](const auto& a, const auto& b)
         {
-            return a.avgPPH > b.avgPPH;
+            return a.avgPPH > b.avgPPH ||
+                (a.avgPPH == b.avgPPH && a.room < b.room);
         });
 
     return result;
 }
 
 
-double computeLastNTimeAvg(const std::vector<Raid>& raids, const std::string& key, int N)
+void finalizeDerivedRaidTimes(std::vector<Raid>& raids)
 {
-    if (raids.empty())
-        return 0.0;
-
-    int start = std::max(0, (int)raids.size() - N);
-    double sum = 0.0;
-    int count = 0;
-
-    for (int i = start; i < (int)raids.size(); ++i)
+    for (auto& r : raids)
     {
-        auto it = raids[i].times.find(key);
-        if (it != raids[i].times.end() && it->second > 0)
+        int prep = 0;
+
+        for (size_t i = 0; i < PREP_ROOM_COUNT; ++i)
         {
-            sum += it->second;
-            ++count;
+            if (r.present & (1u << i))
+                prep += r.times[i];
         }
+
+        int total = r.has(Room::RaidCompleted) ? r.get(Room::RaidCompleted) : 0;
+        int olm = r.has(Room::Olm) ? r.get(Room::Olm) : 0;
+
+        r.totalSeconds = total;
+
+        if (prep > 0)
+            r.set(Room::PreOlm, prep);
+
+        if (total > 0 && prep > 0 && olm > 0)
+            r.set(Room::BetweenRoom, total - prep - olm);
+    }
+}
+
+std::vector<RoomPercentiles> computeRoomPercentiles(const std::map<std::string, Stats>& stats)
+{
+    std::vector<RoomPercentiles> result;
+
+    for (size_t room = 0; room < TIMED_ROOM_COUNT; ++room)
+    {
+        const std::string key(ROOM_NAMES[room]);
+        auto it = stats.find(key);
+        if (it == stats.end() || it->second.validCount == 0)
+            continue;
+
+        const auto& q = it->second.quantiles;
+        result.push_back({
+            key,
+            q.quantile(0.10),
+            q.quantile(0.50),
+            q.quantile(0.90),
+            it->second.validCount,
+            q.exact()
+            });
     }
 
-    return (count > 0) ? (sum / count) : 0.0;
+    return result;
 }
 
-double computeLastNPPH(const std::vector<Raid>& raids, int N)
+LeaderboardEntry computeLeaderboardEntry(const std::string& user, int raids, const std::map<std::string, Stats>& stats)
 {
-    int start = std::max(0, (int)raids.size() - N);
-    double sum = 0.0;
-    int count = 0;
+    LeaderboardEntry e;
+    e.user = user;
+    e.raids = raids;
 
-    for (int i = start; i < (int)raids.size(); ++i)
+    if (auto it = stats.find("Raid Completed"); it != stats.end())
     {
-        const auto& r = raids[i];
-        if (r.totalPoints > 0 && r.totalSeconds > 0)
-        {
-            sum += r.totalPoints / (r.totalSeconds / 3600.0);
-            ++count;
-        }
+        e.best = it->second.fastest;
+        e.avg = it->second.avg;
+        e.median = it->second.quantiles.quantile(0.50);
     }
+    if (auto it = stats.find("Pre-Olm"); it != stats.end())
+        e.preOlm = it->second.avg;
+    if (auto it = stats.find("Olm"); it != stats.end())
+        e.olm = it->second.avg;
 
-    return (count > 0) ? (sum / count) : 0.0;
+    return e;
 }
 
-double computeLastNPoints(const std::vector<Raid>& raids, int N)
+WindowIndex buildWindowIndex(const RaidTable& table)
 {
-    double sum = 0.0;
-    int count = 0;
+    WindowIndex index;
+    appendWindowIndex(index, table);
+    return index;
+}
 
-    for (int i = static_cast<int>(raids.size()) - 1;
-        i >= 0 && count < N;
-        --i)
+void appendWindowIndex(WindowIndex& index, const RaidTable& table)
+{
+    if (index.pointsSum.empty())
     {
-        if (raids[i].totalPoints > 0)
+        // A fresh index is sized once: one entry per row plus the leading zero
+        // Later appends (watch mode) grow the usual way
+        const size_t rows = table.size() + 1;
+        for (size_t room = 0; room < TIMED_ROOM_COUNT; ++room)
         {
-            sum += raids[i].totalPoints;
-            ++count;
+            index.timeSum[room].reserve(rows);
+            index.timeCount[room].reserve(rows);
+            index.timeSum[room].push_back(0);
+            index.timeCount[room].push_back(0);
         }
+        index.pphSum.reserve(rows);
+        index.pphCount.reserve(rows);
+        index.pointsSum.reserve(rows);
+        index.pointsCount.reserve(rows);
+        index.kc.reserve(table.size());
+        index.pphSum.push_back(0.0);
+        index.pphCount.push_back(0);
+        index.pointsSum.push_back(0);
+        index.pointsCount.push_back(0);
     }
 
-    return (count > 0) ? (sum / count) : 0.0;
-}
+    const size_t from = index.size();
+    const int32_t* points = table.totalPoints.data();
+    const int32_t* seconds = table.totalSeconds.data();
 
-void finalizeDerivedRaidTimes(std::vector<Raid>& raids)
-{
-    for (auto& r : raids)
+    // Absent rooms are 0 in the column, so "> 0" covers presence too
+    for (size_t room = 0; room < TIMED_ROOM_COUNT; ++room)
     {
-        int prep = 0;
+        const int32_t* col = table.times[room].data();
+        auto& sum = index.timeSum[room];
+        auto& count = index.timeCount[room];
 
-        for (const auto& room : PREP_ROOMS)
+        for (size_t i = from; i < table.size(); ++i)
         {
-            auto it = r.times.find(room);
-            if (it != r.times.end())
-                prep += it->second;
+            const int t = col[i];
+            sum.push_back(sum.back() + (t > 0 ? t : 0));
+            count.push_back(count.back() + (t > 0 ? 1 : 0));
         }
+    }
 
-        int total = r.times.count("Raid Completed")
-            ? r.times.at("Raid Completed")
-            : 0;
+    for (size_t i = from; i < table.size(); ++i)
+    {
+        const bool hasPPH = points[i] > 0 && seconds[i] > 0;
+        index.pphSum.push_back(index.pphSum.back() + (hasPPH ? points[i] / (seconds[i] / 3600.0) : 0.0));
+        index.pphCount.push_back(index.pphCount.back() + (hasPPH ? 1 : 0));
 
-        int olm = r.times.count("Olm")
-            ? r.times.at("Olm")
-            : 0;
+        const bool hasPoints = points[i] > 0;
+        index.pointsSum.push_back(index.pointsSum.back() + (hasPoints ? points[i] : 0));
+        index.pointsCount.push_back(index.pointsCount.back() + (hasPoints ? 1 : 0));
 
-        r.totalSeconds = total;
+        index.kc.push_back(table.kc[i]);
+    }
+}
 
-        if (prep > 0)
-            r.times["Pre-Olm"] = prep;
+RaidWindow lastNWindow(const WindowIndex& index, int n)
+{
+    const size_t end = index.size();
+    return { end - std::min(end, static_cast<size_t>(std::max(n, 0))), end };
+}
 
-        if (total > 0 && prep > 0 && olm > 0)
-            r.times["Between room time"] = total - prep - olm;
-    }
+RaidWindow kcWindow(const WindowIndex& index, int firstKc, int lastKc)
+{
+    auto begin = std::lower_bound(index.kc.begin(), index.kc.end(), firstKc);
+    auto end = std::upper_bound(begin, index.kc.end(), lastKc);
+    return { static_cast<size_t>(begin - index.kc.begin()), static_cast<size_t>(end - index.kc.begin()) };
+}
+
+double windowTimeAvg(const WindowIndex& index, Room room, RaidWindow w)
+{
+    if (roomIndex(room) >= TIMED_ROOM_COUNT || w.begin >= w.end)
+        return 0.0;
+
+    const auto& sum = index.timeSum[roomIndex(room)];
+    const auto& count = index.timeCount[roomIndex(room)];
+    const int n = count[w.end] - count[w.begin];
+
+    return (n > 0) ? (static_cast<double>(sum[w.end] - sum[w.begin]) / n) : 0.0;
+}
+
+double windowPPH(const WindowIndex& index, RaidWindow w)
+{
+    if (w.begin >= w.end)
+        return 0.0;
+
+    const int n = index.pphCount[w.end] - index.pphCount[w.begin];
+    return (n > 0) ? ((index.pphSum[w.end] - index.pphSum[w.begin]) / n) : 0.0;
 }
 
-std::map<std::string, double> computeLastNStats(const std::vector<Raid>& raids, int lastN)
+double windowPoints(const WindowIndex& index, RaidWindow w)
+{
+    if (w.begin >= w.end)
+        return 0.0;
+
+    const int n = index.pointsCount[w.end] - index.pointsCount[w.begin];
+    return (n > 0) ? (static_cast<double>(index.pointsSum[w.end] - index.pointsSum[w.begin]) / n) : 0.0;
+}
+
+// Points count the last N raids that have points, not the last N rows
+static RaidWindow lastNPointsWindow(const WindowIndex& index, int n)
+{
+    const auto& count = index.pointsCount;
+    const int total = count.back();
+    if (total <= n)
+        return { 0, index.size() };
+
+    auto it = std::lower_bound(count.begin(), count.end(), total - std::max(n, 0));
+    return { static_cast<size_t>(it - count.begin()), index.size() };
+}
+
+std::map<std::string, double> computeWindowStats(const WindowIndex& index, RaidWindow w)
 {
     std::map<std::string, double> result;
 
     // Time-based rows
-    for (const auto& key : DISPLAY_ORDER)
-    {
-        if (key == "Total Points" || key == "PPH")
-            continue;
-
-        result[key] = computeLastNTimeAvg(raids, key, lastN);
-    }
+    for (size_t room = 0; room < TIMED_ROOM_COUNT; ++room)
+        result[std::string(ROOM_NAMES[room])] = windowTimeAvg(index, static_cast<Room>(room), w);
 
     // Points-based rows
-    result["Total Points"] = computeLastNPoints(raids, lastN);
-    result["PPH"] = computeLastNPPH(raids, lastN);
+    result["Total Points"] = windowPoints(index, w);
+    result["PPH"] = windowPPH(index, w);
 
     return result;
 }
 
+std::map<std::string, double> computeLastNStats(const WindowIndex& index, int lastN)
+{
+    auto result = computeWindowStats(index, lastNWindow(index, lastN));
+    result["Total Points"] = windowPoints(index, lastNPointsWindow(index, lastN));
+    return result;
+}
+
 int countPrepRooms(const Raid& r)
 {
-    int count = 0;
-    for (const auto& room : PREP_ROOMS)
-        if (r.times.count(room))
-            ++count;
-    return count;
+    return std::popcount(r.prepMask());
 }
 
 void filterByLayout(std::vector<Raid>& raids, LayoutFilter mode)
@@ -25,27 +25,76 @@ struct RecentCell
     const char* color;
 };
 
+// Rooms with a time column worth averaging (everything before Total Points)
+constexpr size_t TIMED_ROOM_COUNT = roomIndex(Room::TotalPoints);
+
+// Prefix sums over a RaidTable: entry i holds the total of rows [0, i),
+// so the average over any contiguous run of raids is two lookups
+struct WindowIndex
+{
+    std::array<std::vector<int64_t>, TIMED_ROOM_COUNT> timeSum;     // Times > 0 per room
+    std::array<std::vector<int32_t>, TIMED_ROOM_COUNT> timeCount;
+    std::vector<double> pphSum;         // Raids with points and a total time
+    std::vector<int32_t> pphCount;
+    std::vector<int64_t> pointsSum;     // Raids with points > 0
+    std::vector<int32_t> pointsCount;
+    std::vector<int32_t> kc;            // Row -> kc, ascending like the table
+
+    size_t size() const { return kc.size(); }
+};
+
+// Rows [begin, end) of a RaidTable / WindowIndex
+struct RaidWindow
+{
+    size_t begin = 0;
+    size_t end = 0;
+};
+
 std::string secondsToTime(int seconds);
 
-void processStats(std::map<std::string, Stats>& stats, const std::string& key, const std::vector<Raid>& raids, size_t start);
+// Transposes a raid list into columns for the aggregation passes below
+RaidTable buildRaidTable(const std::vector<Raid>& raids);
+
+// Adds raids[from..] as new rows (watch mode appends as raids come in)
+void appendRaidTable(RaidTable& table, const std::vector<Raid>& raids, size_t from);
+
+void processStats(std::map<std::string, Stats>& stats, const std::string& key, const RaidTable& table, size_t start,
+    OutlierMode mode = OutlierMode::Fixed);
 
 std::map<std::string, Stats> initializeStats();
 
-void aggregateStats(std::map<std::string, Stats>& stats, const std::vector<Raid>& raids, size_t start = 0);
+// Feeds raids into the per-room Stats one at a time
+// Rooms are resolved once, so a push costs the same however many raids came before
+struct StatsStream
+{
+    explicit StatsStream(std::map<std::string, Stats>& stats, OutlierMode mode = OutlierMode::Fixed);
+
+    void push(const Raid& raid);
+    void push(const RaidTable& table, size_t row);
+
+private:
+    void add(size_t room, int kc, int t);
 
-std::map<std::string, int> computeRecentRaidTimes(const std::vector<Raid>& raids);
+    std::array<Stats*, DISPLAY_ROOM_COUNT> out{};
+    OutlierMode mode;
+};
+
+void aggregateStats(std::map<std::string, Stats>& stats, const RaidTable& table, size_t start = 0,
+    OutlierMode mode = OutlierMode::Fixed);
+
+std::map<std::string, int> computeRecentRaidTimes(const RaidTable& table);
 
 
-RoomDistribution computeRoomDistribution(const std::vector<Raid>& raids);
+RoomDistribution computeRoomDistribution(const RaidTable& table);
 
 int computeCountPad(const std::map<std::string, Stats>& stats);
 
-std::vector<std::tuple<int, std::string, int, std::string>> collectAndSortDiscarded(
-    const std::map<std::string, Stats>& stats);
+// No record is copied; see DiscardedOutliers
+DiscardedOutliers collectDiscarded(const std::map<std::string, Stats>& stats);
 
 std::vector<std::pair<std::string, const Stats*>> computeMostCommonRooms(const std::map<std::string, Stats>& stats);
 
-int computeTotalWidth(bool hasSecondary);
+int computeTotalWidth(bool hasSecondary, int lastNColumns = 1);
 
 void attachPointsToRaids(std::vector<Raid>& raids, const std::map<int, int>& pointsMap);
 
@@ -58,21 +107,40 @@ void keepMostRecentRaids(std::vector<Raid>& raids, int maxCount);
 
 
 
-PointsAggregate computePointsStats(const std::vector<Raid>& raids);
+PointsAggregate computePointsStats(const RaidTable& table);
 
 PointsToPrint makePointsToPrint(int best, int average, int recent);
 
-std::vector<RoomPPHResult>computeRoomPPH(const std::vector<Raid>& raids);
+std::vector<RoomPPHResult>computeRoomPPH(const RaidTable& table);
 
-double computeLastNTimeAvg(const std::vector<Raid>& raids, const std::string& key, int N);
+void finalizeDerivedRaidTimes(std::vector<Raid>& raids);
 
-double computeLastNPPH(const std::vector<Raid>& raids, int N);
+// p10/p50/p90 of every timed room that has valid samples, in DISPLAY_ORDER
+std::vector<RoomPercentiles> computeRoomPercentiles(const std::map<std::string, Stats>& stats);
 
-double computeLastNPoints(const std::vector<Raid>& raids, int N);
+LeaderboardEntry computeLeaderboardEntry(const std::string& user, int raids, const std::map<std::string, Stats>& stats);
 
-void finalizeDerivedRaidTimes(std::vector<Raid>& raids);
+WindowIndex buildWindowIndex(const RaidTable& table);
+
+// Extends the prefixes with the rows added to table since the last call
+void appendWindowIndex(WindowIndex& index, const RaidTable& table);
+
+RaidWindow lastNWindow(const WindowIndex& index, int n);
+
+// Raids with firstKc <= kc <= lastKc
+RaidWindow kcWindow(const WindowIndex& index, int firstKc, int lastKc);
+
+double windowTimeAvg(const WindowIndex& index, Room room, RaidWindow w);
+
+double windowPPH(const WindowIndex& index, RaidWindow w);
+
+double windowPoints(const WindowIndex& index, RaidWindow w);
+
+// Averages for every DISPLAY_ORDER row over one window
+std::map<std::string, double> computeWindowStats(const WindowIndex& index, RaidWindow w);
 
-std::map<std::string, double> computeLastNStats(const std::vector<Raid>& raids, int lastN);
+// As computeWindowStats for the last N raids; Total Points averages the last N raids that have points
+std::map<std::string, double> computeLastNStats(const WindowIndex& index, int lastN);
 
 int countPrepRooms(const Raid& r);
 
@@ -1,12 +1,21 @@
 ﻿#include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <chrono>
+#include <filesystem>
+#include <optional>
 
 #include "PrintFunctions.h"
 #include "CoxParser.h"
 #include "InputFunctions.h"
 #include "ComputeFunctions.h"
 #include "PointsLoader.h"
+#include "RaidCache.h"
+#include "FileWatcher.h"
+#include "Parallel.h"
+#include "ExportFunctions.h"
+#include "LayoutStats.h"
+#include "Profiler.h"
 
 
 
@@ -14,115 +23,550 @@
 constexpr int ALL_RAIDS = -1;
 constexpr int PAST_RAIDS = ALL_RAIDS;   // ALL_RAIDS or a number
 constexpr int SESSION_RAIDS = 10;       // Number of raids to consider for "Last N" averages
+constexpr bool SHOW_PERCENTILES = true; // p10/p50/p90 table under the main statistics
+constexpr int LAYOUT_TABLE_ROWS = 10;   // Rows per layout / room pair / puzzle family table, 0 hides them
+const std::vector<int> LAST_N_WINDOWS = { SESSION_RAIDS };  // One "Last N" column each, e.g. { 10, 50, 250 }
 const std::string PRIMARY_FILE = "C:\\Users\\DB96\\.runelite\\cox-analytics\\Disco Turtle_CoxTimes.txt";
 const std::string SECONDARY_FILE = "C:\\Users\\DB96\\.runelite\\cox-analytics\\KGod_CoxTimes.txt";
 //                                  ^ Cox analytics export files
 const std::string POINTS_FILE = "C:\\Users\\DB96\\.runelite\\raid-data tracker\\cox\\raid_tracker_data.log";
 //                                  ^ Raid data tracker points file, to match points to the primary raids
 constexpr LayoutFilter LAYOUT_FILTER = LayoutFilter::All;
+constexpr OutlierMode OUTLIER_MODE = OutlierMode::Fixed;  // Fixed reference limits or Adaptive (rolling median/MAD per room and player)
+constexpr ParserMode PARSER_MODE = ParserMode::Mapped;  // Mapped or Stream
+//                                  ^ With USE_RAID_CACHE on, cache updates always parse the mapped file;
+//                                    this only picks the fallback when a file cannot be mapped
+constexpr bool USE_RAID_CACHE = true;   // Keep parsed input in "<file>.coxcache" next to each source
+constexpr int WATCH_TIMEOUT_MS = 1000;  // --watch: longest wait before re-checking the files
+
+
+
+
+// One player's raids after the points join and filters, with the column
+// copy and per-room stats the report is built from
+struct PlayerData {
+    std::string user;
+    std::vector<Raid> raids;
+    RaidTable table;
+    WindowIndex windows;
+    std::map<std::string, Stats> stats;
+};
+
+// The cache holds every solo raid, so a solo query is a filter over the
+// cached records; any other team size re-scans the file with the query
+// pushed into the parser
+static bool loadRaids(const std::string& path, std::vector<Raid>& raids, std::vector<PrimaryRaid>* keys,
+    const RaidQuery& query = DEFAULT_RAID_QUERY)
+{
+    if (!USE_RAID_CACHE || !query.cacheCompatible())
+        return readRaids(path, raids, PARSER_MODE, keys, &query);
+
+    readRaidsCached(path, raids, PARSER_MODE, keys);
+    if (query.active())
+        std::erase_if(raids, [&](const Raid& r) { return !query.acceptsRaid(r); });
+    return !raids.empty();
+}
+
+// Same split for the tracker log; the rest of the query is applied by
+// matchPoints to the entry each raid is joined with
+static std::vector<PointsRaid> loadPointsEntries(const RaidQuery& query)
+{
+    if (!USE_RAID_CACHE || !query.cacheCompatible())
+        return loadPointsFile(POINTS_FILE, &query);
+    return loadPointsFileCached(POINTS_FILE);
+}
+
+// IMPORTANT: order matters (attach -> filter -> trim)
+static void preparePrimaryRaids(std::vector<Raid>& raids, const std::map<int, int>& pointsMap)
+{
+    {
+        ProfileScope phase("Points join");
+        attachPointsToRaids(raids, pointsMap);
+    }
+    {
+        ProfileScope phase("Filter");
+        filterRaidsWithPoints(raids);
+        keepMostRecentRaids(raids, PAST_RAIDS);
+    }
+    {
+        ProfileScope phase("Derive");
+        finalizeDerivedRaidTimes(raids);
+    }
+    ProfileScope phase("Filter");
+    //Mainly separating full layout vs normal layout raids
+    filterByLayout(raids, LAYOUT_FILTER);
+}
+
+static void prepareSecondaryRaids(std::vector<Raid>& raids)
+{
+    {
+        ProfileScope phase("Filter");
+        keepMostRecentRaids(raids, PAST_RAIDS);
+    }
+    {
+        ProfileScope phase("Derive");
+        finalizeDerivedRaidTimes(raids);
+    }
+    ProfileScope phase("Filter");
+    filterByLayout(raids, LAYOUT_FILTER);
+}
+
+static void rebuildAggregates(PlayerData& player)
+{
+    ProfileScope phase("Aggregation");
+    player.table = buildRaidTable(player.raids);
+    player.windows = buildWindowIndex(player.table);
+    player.stats = initializeStats();
+    aggregateStats(player.stats, player.table, 0, OUTLIER_MODE);
+}
+
+// Adds already prepared raids; the stats only see the new ones
+static void appendAggregates(PlayerData& player, const std::vector<Raid>& fresh)
+{
+    const size_t start = player.raids.size();
+    player.raids.insert(player.raids.end(), fresh.begin(), fresh.end());
+    appendRaidTable(player.table, player.raids, start);
+    appendWindowIndex(player.windows, player.table);
+
+    StatsStream stream(player.stats, OUTLIER_MODE);
+    for (const auto& r : fresh)
+        stream.push(r);
+}
+
+static void printReport(TextBuffer& out, const PlayerData& primary, const PlayerData& secondary, bool hasSecondary, const JoinStats& join,
+    const RaidQuery& query = DEFAULT_RAID_QUERY)
+{
+    // ====================== AGGREGATION ========================
+    // Compute per-room, per-raid, and points-based statistics
+
+    std::optional<ProfileScope> phase(std::in_place, "Aggregation");
+    auto agg = computePointsStats(primary.table);
+
+    PointsToPrint pointStats = makePointsToPrint(agg.bestPoints, agg.avgPoints,
+        primary.raids.back().totalPoints);
+    PointsToPrint pphStats = makePointsToPrint(agg.bestPPH, agg.avgPPH, agg.recentPPH);
+
+    auto recentTimes = computeRecentRaidTimes(primary.table);
+
+
+    std::vector<std::pair<std::string, const Stats*>> common = computeMostCommonRooms(primary.stats);
+    RoomDistribution rd = computeRoomDistribution(primary.table);
+
+    DiscardedOutliers primaryDiscarded, secondaryDiscarded;
+	primaryDiscarded = collectDiscarded(primary.stats);
+    if (hasSecondary)
+		secondaryDiscarded = collectDiscarded(secondary.stats);
+
+    auto roomPPH = computeRoomPPH(primary.table); // time-weighted PPH per room
+    LayoutAnalysis layouts = computeLayoutAnalysis(primary.table);
+
+    std::vector<std::map<std::string, double>> lastNAvgs;
+    for (int n : LAST_N_WINDOWS)
+        lastNAvgs.push_back(computeLastNStats(primary.windows, n));
 
+    int totalWidth = computeTotalWidth(hasSecondary, static_cast<int>(LAST_N_WINDOWS.size())); // For table frame
 
+    const std::map<std::string, Stats> noStats;
+    const auto& secondaryStats = hasSecondary ? secondary.stats : noStats;
 
 
-void runCoxAnalytics() {
+
+	
+    // ======================== OUTPUT ===========================
+    // Print tables and summaries
+
+    phase.emplace("Output");
+    printAnalysisSummary(out, primary.user, static_cast<int>(primary.raids.size()), hasSecondary, secondary.user,
+        PAST_RAIDS, static_cast<int>(secondary.raids.size()), query.teamSize);
+    printJoinSummary(out, join);
+
+	printRaidStatisticsHeader(out, primary.user, secondary.user, hasSecondary, totalWidth, LAST_N_WINDOWS);
+
+	printStatsTable(out, primary.stats, secondaryStats, recentTimes, secondary.user,
+        totalWidth, hasSecondary, pphStats, pointStats, lastNAvgs);
+
+    if (SHOW_PERCENTILES)
+        printPercentileTable(out, computeRoomPercentiles(primary.stats));
+
+    if (LAYOUT_FILTER != LayoutFilter::FullOnly)
+    {
+    printRoomPPHTable(out, roomPPH);
+	printMostCommonPrepRooms(out, common, rd.five, rd.six, rd.other, static_cast<int>(primary.raids.size()));
+    if (LAYOUT_TABLE_ROWS > 0)
+        printLayoutTables(out, layouts, LAYOUT_TABLE_ROWS);
+    }
+
+	printDiscardedOutliers(out, primaryDiscarded, primary.user, "Primary");
+	if (hasSecondary)
+	    printDiscardedOutliers(out, secondaryDiscarded, secondary.user, "Secondary");
+}
+
+
+// Reads both exports, joins points and builds the aggregates the report
+// and the export are made from; false if there is nothing to analyze
+static bool loadAnalysis(PlayerData& primary, PlayerData& secondary, bool& hasSecondary, JoinStats& join,
+    const RaidQuery& query)
+{
     // ========================== INPUT ==========================
 	// Read primary / secondary raid logs from Cox Analytics
 
 	// A raid contains kc, times per room, total time, total points
-    std::vector<Raid> primaryRaids, secondaryRaids;
-
-    if (!readRaids(PRIMARY_FILE, primaryRaids)) {
-        std::cerr << "Failed to read primary file\n";
-        return;
+    // The primary scan also yields the keys used for the points join
+    primary.user = getUsername(PRIMARY_FILE);
+    secondary.user = getUsername(SECONDARY_FILE);
+    std::vector<PrimaryRaid> primaryJoinKeys;
+    {
+        ProfileScope phase("Input");
+        if (!loadRaids(PRIMARY_FILE, primary.raids, &primaryJoinKeys, query)) {
+            if (query.active() && std::filesystem::exists(PRIMARY_FILE))
+                std::cout << "No raids match the query.\n";
+            else
+                std::cerr << "Failed to read primary file\n";
+            return false;
+        }
+        // Mode, date and points come from the tracker join, which only the
+        // primary player goes through, so such a query leaves the secondary out
+        if (!query.needsPoints()) {
+            bool secondaryOk = loadRaids(SECONDARY_FILE, secondary.raids, nullptr, query);
+            hasSecondary = secondaryOk && !secondary.raids.empty();
+        }
     }
-    bool secondaryOk = readRaids(SECONDARY_FILE, secondaryRaids);
-    bool hasSecondary = secondaryOk && !secondaryRaids.empty();
-    if (hasSecondary)
-        keepMostRecentRaids(secondaryRaids, PAST_RAIDS);
-
-    std::string primaryUser = getUsername(PRIMARY_FILE);
-    std::string secondaryUser = getUsername(SECONDARY_FILE);
 
     // ======================= POINTS JOIN =======================
 	// Load raid points from Raid Data Tracker and attach to primary raids
-    // IMPORTANT: order matters (attach -> filter -> trim)
 
-    auto pointsMap = loadPoints(PRIMARY_FILE, POINTS_FILE);
-    attachPointsToRaids(primaryRaids, pointsMap);
-    filterRaidsWithPoints(primaryRaids);
-    keepMostRecentRaids(primaryRaids, PAST_RAIDS);
+    std::map<int, int> pointsMap;
+    {
+        ProfileScope phase("Points join");
+        pointsMap = matchPoints(primaryJoinKeys, loadPointsEntries(query), &join, nullptr, &query);
+    }
+    preparePrimaryRaids(primary.raids, pointsMap);
+    if (hasSecondary)
+        prepareSecondaryRaids(secondary.raids);
+    keepMostRecentRaids(primary.raids, query.last);
+    keepMostRecentRaids(secondary.raids, query.last);
 
-    if (primaryRaids.empty())
+    if (primary.raids.empty())
     {
-        std::cout << "No raids to analyze.\n";
-        return;
+        std::cout << (query.active() ? "No raids match the query.\n" : "No raids to analyze.\n");
+        return false;
     }
 
-	finalizeDerivedRaidTimes(primaryRaids);
+    rebuildAggregates(primary);
     if (hasSecondary)
-        finalizeDerivedRaidTimes(secondaryRaids);
+        rebuildAggregates(secondary);
 
-	//Mainly separating full layout vs normal layout raids
-    filterByLayout(primaryRaids, LAYOUT_FILTER);
-    filterByLayout(secondaryRaids, LAYOUT_FILTER);
+    profileCount("raids analyzed", static_cast<int64_t>(primary.raids.size() + secondary.raids.size()));
+    return true;
+}
 
+void runCoxAnalytics(const RaidQuery& query) {
+    PlayerData primary, secondary;
+    bool hasSecondary = false;
+    JoinStats join;
+    if (!loadAnalysis(primary, secondary, hasSecondary, join, query))
+        return;
 
+    TextBuffer out;
+    if (query.active())
+    {
+        out.put("Query: ").put(query.text).put('\n');
+        if (query.needsPoints())
+            out.put("(mode, date and points need the tracker log, so the secondary player is left out)\n");
+    }
+    printReport(out, primary, secondary, hasSecondary, join, query);
 
-    // ====================== AGGREGATION ========================
-    // Compute per-room, per-raid, and points-based statistics
+    ProfileScope phase("Output");
+    out.flush();
+}
 
-    auto agg = computePointsStats(primaryRaids);
 
-    PointsToPrint pointStats = makePointsToPrint(agg.bestPoints, agg.avgPoints,
-        primaryRaids.back().totalPoints);
-    PointsToPrint pphStats = makePointsToPrint(agg.bestPPH, agg.avgPPH, agg.recentPPH);
+// ======================== EXPORT MODE ==========================
+// The report's tables as JSON lines and CSV, one file pair per table
 
-    std::map<std::string, Stats> primaryStats, secondaryStats;
-	primaryStats = initializeStats();
-    if (hasSecondary)
-	    secondaryStats = initializeStats();
-    aggregateStats(primaryStats, primaryRaids);
-    if (hasSecondary)
-        aggregateStats(secondaryStats, secondaryRaids);
-
-    auto recentTimes = computeRecentRaidTimes(primaryRaids);
+bool runExportMode(const std::string& directory, const RaidQuery& query) {
+    PlayerData primary, secondary;
+    bool hasSecondary = false;
+    JoinStats join;
+    if (!loadAnalysis(primary, secondary, hasSecondary, join, query))
+        return false;
 
+    ProfileScope phase("Output");
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec)
+    {
+        std::cerr << "Cannot create " << directory << ": " << ec.message() << "\n";
+        return false;
+    }
 
-    std::vector<std::pair<std::string, const Stats*>> common = computeMostCommonRooms(primaryStats);
-    RoomDistribution rd = computeRoomDistribution(primaryRaids);
+    ExportTable stats, points, roomPPH, layouts, layoutStats, lastN, discarded;
 
-    std::vector<std::tuple<int, std::string, int, std::string>> primaryDiscarded, secondaryDiscarded;
-	primaryDiscarded = collectAndSortDiscarded(primaryStats);
+    exportStats(stats, primary.user, primary.stats);
+    exportPoints(points, primary.user, computePointsStats(primary.table));
+    exportDiscarded(discarded, primary.user, collectDiscarded(primary.stats));
     if (hasSecondary)
-		secondaryDiscarded = collectAndSortDiscarded(secondaryStats);
+    {
+        exportStats(stats, secondary.user, secondary.stats);
+        exportDiscarded(discarded, secondary.user, collectDiscarded(secondary.stats));
+    }
 
-    auto roomPPH = computeRoomPPH(primaryRaids); // time-weighted PPH per room
+    exportRoomPPH(roomPPH, computeRoomPPH(primary.table));
+    exportLayouts(layouts, computeRoomDistribution(primary.table));
+    exportLayoutStats(layoutStats, computeLayoutAnalysis(primary.table));
+    for (int n : LAST_N_WINDOWS)
+        exportLastN(lastN, n, computeLastNStats(primary.windows, n));
+
+    bool ok = writeExportTable(directory, "stats", stats);
+    ok = writeExportTable(directory, "points", points) && ok;
+    ok = writeExportTable(directory, "room_pph", roomPPH) && ok;
+    ok = writeExportTable(directory, "layouts", layouts) && ok;
+    ok = writeExportTable(directory, "layout_stats", layoutStats) && ok;
+    ok = writeExportTable(directory, "last_n", lastN) && ok;
+    ok = writeExportTable(directory, "discarded", discarded) && ok;
+
+    if (ok)
+        std::cout << "Exported " << primary.raids.size() << " raids from " << primary.user
+            << " to " << directory << "\n";
+    return ok;
+}
+
+
+// ======================== COMPARE MODE =========================
+// Every *_CoxTimes.txt in a directory, one pipeline per player
+
+static PlayerData loadPlayer(const std::string& path, const RaidQuery& query)
+{
+    PlayerData player;
+    player.user = getUsername(path);
+
+    if (loadRaids(path, player.raids, nullptr, query))
+        prepareSecondaryRaids(player.raids);
+    keepMostRecentRaids(player.raids, query.last);
+    if (!player.raids.empty())
+        rebuildAggregates(player);
+    return player;
+}
+
+bool runCompareMode(const std::string& directory, const RaidQuery& query) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+    {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.ends_with("_CoxTimes.txt"))
+            files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
 
-    auto lastNAvg = computeLastNStats(primaryRaids, SESSION_RAIDS);
+    if (ec)
+    {
+        std::cerr << "Cannot read " << directory << ": " << ec.message() << "\n";
+        return false;
+    }
+    if (files.empty())
+    {
+        std::cerr << "No *_CoxTimes.txt files in " << directory << "\n";
+        return false;
+    }
 
-    int totalWidth = computeTotalWidth(hasSecondary); // For table frame
+    // Players are independent: parse, derive and aggregate each on a worker
+    std::vector<PlayerData> players(files.size());
+    {
+        ProfileScope phase("Load players");
+        parallelFor(files.size(), [&](size_t i) {
+            players[i] = loadPlayer(files[i], query);
+        });
+    }
 
+    std::vector<LeaderboardEntry> rows;
+    for (const auto& p : players)
+        if (!p.raids.empty())
+            rows.push_back(computeLeaderboardEntry(p.user, static_cast<int>(p.raids.size()), p.stats));
+
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        return a.avg < b.avg || (a.avg == b.avg && a.user < b.user);
+        });
+
+    ProfileScope phase("Output");
+    TextBuffer out;
+    if (query.active())
+        out.put("Query: ").put(query.text).put('\n');
+    printLeaderboard(out, rows, directory, static_cast<int>(players.size() - rows.size()));
+    out.flush();
+    return true;
+}
+
+
+// ========================= WATCH MODE ==========================
+// Keeps the parsed files in memory and only parses what the plugins append
+
+struct WatchSession {
+    RaidFileState primaryFile, secondaryFile;
+    PointsFileState pointsFile;
+    PlayerData primary, secondary;
+    size_t primaryConsumed = 0;     // Raids of primaryFile already joined or dropped
+    size_t secondaryConsumed = 0;
+    std::map<int, int> pointsMap;   // Join result the primary aggregates were built from
+    JoinStats join;
+    Arena scratch;                  // Released at the start of every refresh
+};
+
+// Raids from `from` on that found their tracker line, with points attached.
+// Returns the index just past the newest matched raid: older raids without
+// points are dropped like in batch mode, newer ones may still get their line
+static size_t takeMatchedRaids(const std::vector<Raid>& all, size_t from,
+    const std::map<int, int>& pointsMap, std::vector<Raid>& out)
+{
+    size_t consumed = from;
+    for (size_t i = from; i < all.size(); ++i)
+    {
+        auto it = pointsMap.find(all[i].kc);
+        if (it == pointsMap.end() || it->second < 0)
+            continue;
+        out.push_back(all[i]);
+        out.back().totalPoints = it->second;
+        consumed = i + 1;
+    }
+    return consumed;
+}
+
+// The join is order tolerant, so new tracker lines can also match (or
+// re-match) raids that were already consumed; those need a rebuild
+static bool consumedJoinChanged(const WatchSession& s, const std::map<int, int>& pointsMap)
+{
+    for (size_t i = 0; i < s.primaryConsumed; ++i)
+    {
+        const int kc = s.primaryFile.raids[i].kc;
+        auto before = s.pointsMap.find(kc);
+        auto now = pointsMap.find(kc);
+        const int a = (before == s.pointsMap.end()) ? -1 : before->second;
+        const int b = (now == pointsMap.end()) ? -1 : now->second;
+        if (a != b)
+            return true;
+    }
+    return false;
+}
+
+// Runs the batch pipeline on the in-memory file states, without re-parsing
+static void rebuildSession(WatchSession& s, std::map<int, int> pointsMap)
+{
+    s.pointsMap = std::move(pointsMap);
+
+    s.primary.raids.clear();
+    s.primaryConsumed = takeMatchedRaids(s.primaryFile.raids, 0, s.pointsMap, s.primary.raids);
+    keepMostRecentRaids(s.primary.raids, PAST_RAIDS);
+    finalizeDerivedRaidTimes(s.primary.raids);
+    filterByLayout(s.primary.raids, LAYOUT_FILTER);
+
+    s.secondary.raids = s.secondaryFile.raids;
+    s.secondaryConsumed = s.secondaryFile.raids.size();
+    prepareSecondaryRaids(s.secondary.raids);
+
+    rebuildAggregates(s.primary);
+    rebuildAggregates(s.secondary);
+}
+
+// Returns the number of raids that reached the aggregates
+static int refreshSession(WatchSession& s)
+{
+    s.scratch.release();
+
+    const int primaryAdded = updateRaidFile(PRIMARY_FILE, s.primaryFile);
+    const int secondaryAdded = updateRaidFile(SECONDARY_FILE, s.secondaryFile);
+    const int pointsAdded = updatePointsFile(POINTS_FILE, s.pointsFile);
+
+    const bool restarted = s.primaryFile.restarted || s.secondaryFile.restarted || s.pointsFile.restarted;
+    if (!restarted && primaryAdded <= 0 && secondaryAdded <= 0 && pointsAdded <= 0)
+        return 0;
+
+    auto pointsMap = (restarted || primaryAdded > 0 || pointsAdded > 0)
+        ? matchPoints(s.primaryFile.joinKeys, s.pointsFile.points, &s.join, &s.scratch)
+        : s.pointsMap;
+
+    // A rewritten file, a changed join or a sliding PAST_RAIDS window cannot be patched in place
+    if (restarted || PAST_RAIDS != ALL_RAIDS || consumedJoinChanged(s, pointsMap))
+    {
+        rebuildSession(s, std::move(pointsMap));
+        return 1;
+    }
 
+    int added = 0;
 
-	
-    // ======================== OUTPUT ===========================
-    // Print tables and summaries
+    if (primaryAdded > 0 || pointsAdded > 0)
+    {
+        std::vector<Raid> fresh;
+        s.primaryConsumed = takeMatchedRaids(s.primaryFile.raids, s.primaryConsumed, pointsMap, fresh);
+        s.pointsMap = std::move(pointsMap);
+
+        finalizeDerivedRaidTimes(fresh);
+        filterByLayout(fresh, LAYOUT_FILTER);
+        appendAggregates(s.primary, fresh);
+        added += static_cast<int>(fresh.size());
+    }
 
-    printAnalysisSummary(primaryUser, static_cast<int>(primaryRaids.size()), hasSecondary, secondaryUser,
-        PAST_RAIDS, static_cast<int>(secondaryRaids.size()));
+    if (secondaryAdded > 0)
+    {
+        std::vector<Raid> fresh(s.secondaryFile.raids.begin() + s.secondaryConsumed, s.secondaryFile.raids.end());
+        s.secondaryConsumed = s.secondaryFile.raids.size();
 
-	printRaidStatisticsHeader(primaryUser, secondaryUser, hasSecondary, totalWidth, SESSION_RAIDS);
+        finalizeDerivedRaidTimes(fresh);
+        filterByLayout(fresh, LAYOUT_FILTER);
+        appendAggregates(s.secondary, fresh);
+        added += static_cast<int>(fresh.size());
+    }
 
-	printStatsTable(primaryStats, secondaryStats, recentTimes, secondaryUser,
-        totalWidth, hasSecondary, pphStats, pointStats, lastNAvg);
+    return added;
+}
+
+// The whole frame goes out in one write so the terminal never shows half a redraw
+static void drawSession(const WatchSession& s, double refreshMs)
+{
+    TextBuffer out;
+    out.put("\033[2J\033[H");   // clear screen, cursor home
+
+    if (s.primary.raids.empty())
+        out.put("No raids to analyze.\n");
+    else
+        printReport(out, s.primary, s.secondary, !s.secondary.raids.empty(), s.join);
+
+    out.put("Watching for new raids (Ctrl+C to quit) - last refresh ")
+        .fixed(refreshMs, 1).put(" ms\n");
+    out.flush();
+}
+
+void runWatchMode() {
+    WatchSession session;
+    session.primary.user = getUsername(PRIMARY_FILE);
+    session.secondary.user = getUsername(SECONDARY_FILE);
+
+    FileWatcher watcher;
+    watcher.add(PRIMARY_FILE);
+    watcher.add(SECONDARY_FILE);
+    watcher.add(POINTS_FILE);
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (updateRaidFile(PRIMARY_FILE, session.primaryFile) < 0) {
+        std::cerr << "Failed to read primary file\n";
+        return;
+    }
+    updateRaidFile(SECONDARY_FILE, session.secondaryFile);
+    updatePointsFile(POINTS_FILE, session.pointsFile);
+    rebuildSession(session, matchPoints(session.primaryFile.joinKeys, session.pointsFile.points, &session.join, &session.scratch));
+    auto t1 = std::chrono::steady_clock::now();
+    drawSession(session, std::chrono::duration<double, std::milli>(t1 - t0).count());
 
-    if (LAYOUT_FILTER != LayoutFilter::FullOnly)
+    while (true)
     {
-    printRoomPPHTable(roomPPH);
-	printMostCommonPrepRooms(common, rd.five, rd.six, rd.other, static_cast<int>(primaryRaids.size()));
-    }
+        // A timeout re-checks too: notifications can be dropped (inotify queue
+        // overflow) or late (Windows while RuneLite holds the log open)
+        watcher.wait(WATCH_TIMEOUT_MS);
 
-	printDiscardedOutliers(primaryDiscarded, primaryUser, "Primary");
-	if (hasSecondary)
-	    printDiscardedOutliers(secondaryDiscarded, secondaryUser, "Secondary");
-}
\ No newline at end of file
+        t0 = std::chrono::steady_clock::now();
+        int added = refreshSession(session);
+        t1 = std::chrono::steady_clock::now();
+
+        if (added != 0)
+            drawSession(session, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+}
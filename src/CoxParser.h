@@ -1,3 +1,19 @@
 #pragma once
 
-void runCoxAnalytics();
\ No newline at end of file
+#include <string>
+
+#include "RaidQuery.h"
+
+// query narrows the raids analyzed; see parseRaidQuery
+void runCoxAnalytics(const RaidQuery& query = DEFAULT_RAID_QUERY);
+
+// --watch: redraw the report whenever the plugins append a raid
+void runWatchMode();
+
+// --compare <dir>: leaderboard over every *_CoxTimes.txt in dir
+// False when the directory cannot be read or holds no such file
+bool runCompareMode(const std::string& directory, const RaidQuery& query = DEFAULT_RAID_QUERY);
+
+// --export <dir>: the report's tables as <table>.jsonl and <table>.csv in dir
+// False when there was nothing to export or a file could not be written
+bool runExportMode(const std::string& directory, const RaidQuery& query = DEFAULT_RAID_QUERY);
\ No newline at end of file
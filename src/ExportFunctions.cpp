@@ -0,0 +1,278 @@
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+
+#include "ExportFunctions.h"
+
+// "text" with JSON escapes
+static TextBuffer& jsonString(TextBuffer& out, std::string_view s)
+{
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    out.put('"');
+    for (char c : s)
+    {
+        const unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+            out.put('\\').put(c);
+        else if (u < 0x20)
+            out.put("\\u00").put(HEX[u >> 4]).put(HEX[u & 0xF]);
+        else
+            out.put(c);
+    }
+    return out.put('"');
+}
+
+// Quoted only when the field holds a separator, quote or line break
+static TextBuffer& csvField(TextBuffer& out, std::string_view s)
+{
+    if (s.find_first_of(",\"\r\n") == std::string_view::npos)
+        return out.put(s);
+
+    out.put('"');
+    for (char c : s)
+    {
+        if (c == '"')
+            out.put('"');
+        out.put(c);
+    }
+    return out.put('"');
+}
+
+// A value with no samples behind it: null in JSON, an empty field in CSV
+static TextBuffer& jsonNumber(TextBuffer& out, std::optional<int> v)
+{
+    return v ? out.put(*v) : out.put("null");
+}
+
+static TextBuffer& jsonNumber(TextBuffer& out, std::optional<double> v)
+{
+    return v ? out.fixed(*v, 2) : out.put("null");
+}
+
+static TextBuffer& csvNumber(TextBuffer& out, std::optional<int> v)
+{
+    return v ? out.put(*v) : out;
+}
+
+static TextBuffer& csvNumber(TextBuffer& out, std::optional<double> v)
+{
+    return v ? out.fixed(*v, 2) : out;
+}
+
+void exportStats(ExportTable& t, const std::string& user, const std::map<std::string, Stats>& stats)
+{
+    if (t.csv.data.empty())
+        t.csv.put("player,room,count,avg,stddev,best,p10,p50,p90,discarded\n");
+
+    // DISPLAY_ORDER up to "Total Points"; the points rows have no samples
+    for (size_t i = 0; i < TIMED_ROOM_COUNT; ++i)
+    {
+        const std::string& room = DISPLAY_ORDER[i];
+        auto it = stats.find(room);
+        if (it == stats.end())
+            continue;
+
+        // A room with only outliers (or never visited) has count 0 and nothing else
+        const Stats& st = it->second;
+        std::optional<double> avg, stddev;
+        std::optional<int> best, p10, p50, p90;
+        if (st.validCount > 0)
+        {
+            avg = st.avg;
+            stddev = std::sqrt(st.running.variance());
+            best = st.fastest;
+            p10 = st.quantiles.quantile(0.10);
+            p50 = st.quantiles.quantile(0.50);
+            p90 = st.quantiles.quantile(0.90);
+        }
+        const int discarded = static_cast<int>(st.discarded.size());
+
+        jsonString(t.jsonl.put("{\"player\":"), user);
+        jsonString(t.jsonl.put(",\"room\":"), room);
+        t.jsonl.put(",\"count\":").put(st.validCount);
+        jsonNumber(t.jsonl.put(",\"avg\":"), avg);
+        jsonNumber(t.jsonl.put(",\"stddev\":"), stddev);
+        jsonNumber(t.jsonl.put(",\"best\":"), best);
+        jsonNumber(t.jsonl.put(",\"p10\":"), p10);
+        jsonNumber(t.jsonl.put(",\"p50\":"), p50);
+        jsonNumber(t.jsonl.put(",\"p90\":"), p90);
+        t.jsonl.put(",\"discarded\":").put(discarded).put("}\n");
+
+        csvField(t.csv, user).put(',');
+        csvField(t.csv, room).put(',');
+        t.csv.put(st.validCount).put(',');
+        csvNumber(t.csv, avg).put(',');
+        csvNumber(t.csv, stddev).put(',');
+        csvNumber(t.csv, best).put(',');
+        csvNumber(t.csv, p10).put(',');
+        csvNumber(t.csv, p50).put(',');
+        csvNumber(t.csv, p90).put(',');
+        t.csv.put(discarded).put('\n');
+    }
+}
+
+void exportPoints(ExportTable& t, const std::string& user, const PointsAggregate& agg)
+{
+    if (t.csv.data.empty())
+        t.csv.put("player,best_points,avg_points,best_pph,avg_pph,recent_pph\n");
+
+    jsonString(t.jsonl.put("{\"player\":"), user);
+    t.jsonl.put(",\"best_points\":").put(agg.bestPoints)
+        .put(",\"avg_points\":").put(agg.avgPoints)
+        .put(",\"best_pph\":").put(agg.bestPPH)
+        .put(",\"avg_pph\":").put(agg.avgPPH)
+        .put(",\"recent_pph\":").put(agg.recentPPH)
+        .put("}\n");
+
+    csvField(t.csv, user).put(',');
+    t.csv.put(agg.bestPoints).put(',').put(agg.avgPoints).put(',')
+        .put(agg.bestPPH).put(',').put(agg.avgPPH).put(',').put(agg.recentPPH).put('\n');
+}
+
+void exportRoomPPH(ExportTable& t, const std::vector<RoomPPHResult>& rows)
+{
+    if (t.csv.data.empty())
+        t.csv.put("room,avg_pph,raids\n");
+
+    for (const auto& r : rows)
+    {
+        jsonString(t.jsonl.put("{\"room\":"), r.room);
+        t.jsonl.put(",\"avg_pph\":").put(r.avgPPH)
+            .put(",\"raids\":").put(r.raids)
+            .put("}\n");
+
+        csvField(t.csv, r.room).put(',');
+        t.csv.put(r.avgPPH).put(',').put(r.raids).put('\n');
+    }
+}
+
+void exportLayouts(ExportTable& t, const RoomDistribution& rd)
+{
+    if (t.csv.data.empty())
+        t.csv.put("prep_rooms,raids,percent\n");
+
+    const int total = rd.five + rd.six + rd.other;
+    const std::pair<const char*, int> rows[] = {
+        { "5", rd.five },
+        { "6", rd.six },
+        { "other", rd.other },
+    };
+
+    for (const auto& [label, raids] : rows)
+    {
+        const double pct = total > 0 ? raids * 100.0 / total : 0.0;
+
+        jsonString(t.jsonl.put("{\"prep_rooms\":"), label);
+        t.jsonl.put(",\"raids\":").put(raids)
+            .put(",\"percent\":").fixed(pct, 2)
+            .put("}\n");
+
+        t.csv.put(label).put(',').put(raids).put(',').fixed(pct, 2).put('\n');
+    }
+}
+
+void exportLayoutStats(ExportTable& t, const LayoutAnalysis& layouts)
+{
+    if (t.csv.data.empty())
+        t.csv.put("group,mask,rooms,raids,percent,avg_seconds,avg_pph\n");
+
+    const std::pair<const char*, const std::vector<LayoutResult>*> groups[] = {
+        { "layout", &layouts.layouts },
+        { "pair", &layouts.pairs },
+        { "family", &layouts.families },
+    };
+
+    for (const auto& [group, rows] : groups)
+    {
+        for (const auto& r : *rows)
+        {
+            const std::string rooms = layoutLabel(r.mask, "|");
+
+            jsonString(t.jsonl.put("{\"group\":"), group);
+            t.jsonl.put(",\"mask\":").put(static_cast<int>(r.mask));
+            jsonString(t.jsonl.put(",\"rooms\":"), rooms);
+            t.jsonl.put(",\"raids\":").put(r.raids)
+                .put(",\"percent\":").fixed(r.percent, 2)
+                .put(",\"avg_seconds\":").put(r.avgSeconds)
+                .put(",\"avg_pph\":").put(r.avgPPH)
+                .put("}\n");
+
+            t.csv.put(group).put(',').put(static_cast<int>(r.mask)).put(',');
+            csvField(t.csv, rooms).put(',');
+            t.csv.put(r.raids).put(',').fixed(r.percent, 2).put(',')
+                .put(r.avgSeconds).put(',').put(r.avgPPH).put('\n');
+        }
+    }
+}
+
+void exportLastN(ExportTable& t, int n, const std::map<std::string, double>& avgs)
+{
+    if (t.csv.data.empty())
+        t.csv.put("n,room,avg\n");
+
+    for (const auto& room : DISPLAY_ORDER)
+    {
+        auto it = avgs.find(room);
+        if (it == avgs.end())
+            continue;
+
+        // 0 means the window held no sample for the room
+        const std::optional<double> avg = it->second > 0.0 ? std::optional(it->second) : std::nullopt;
+
+        t.jsonl.put("{\"n\":").put(n);
+        jsonString(t.jsonl.put(",\"room\":"), room);
+        jsonNumber(t.jsonl.put(",\"avg\":"), avg).put("}\n");
+
+        t.csv.put(n).put(',');
+        csvField(t.csv, room).put(',');
+        csvNumber(t.csv, avg).put('\n');
+    }
+}
+
+void exportDiscarded(ExportTable& t, const std::string& user,
+    const DiscardedOutliers& discarded)
+{
+    if (t.csv.data.empty())
+        t.csv.put("player,kc,room,time,reason\n");
+
+    discarded.forEach([&](const OutlierRecord& d)
+    {
+        const std::string_view room = d.roomName();
+        const std::string_view reason = outlierReasonText(d.reason);
+        jsonString(t.jsonl.put("{\"player\":"), user);
+        t.jsonl.put(",\"kc\":").put(d.kc);
+        jsonString(t.jsonl.put(",\"room\":"), room);
+        t.jsonl.put(",\"time\":").put(d.time);
+        jsonString(t.jsonl.put(",\"reason\":"), reason);
+        t.jsonl.put("}\n");
+
+        csvField(t.csv, user).put(',');
+        t.csv.put(d.kc).put(',');
+        csvField(t.csv, room).put(',');
+        t.csv.put(d.time).put(',');
+        csvField(t.csv, reason).put('\n');
+    });
+}
+
+static bool writeFile(const std::filesystem::path& path, const TextBuffer& buf)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(buf.data.data(), static_cast<std::streamsize>(buf.data.size()));
+    if (!out)
+    {
+        std::cerr << "Cannot write " << path.string() << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool writeExportTable(const std::string& directory, const std::string& name, const ExportTable& t)
+{
+    const std::filesystem::path dir(directory);
+    const bool jsonOk = writeFile(dir / (name + ".jsonl"), t.jsonl);
+    const bool csvOk = writeFile(dir / (name + ".csv"), t.csv);
+    return jsonOk && csvOk;
+}
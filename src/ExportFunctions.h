@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+
+#include "Types.h"
+#include "ComputeFunctions.h"
+#include "TextBuffer.h"
+#include "LayoutStats.h"
+
+// One exported table, built as JSON lines and CSV side by side and written
+// to <dir>/<name>.jsonl and <dir>/<name>.csv
+// Rows are formatted straight from the aggregates into the two buffers
+struct ExportTable
+{
+    TextBuffer jsonl;
+    TextBuffer csv;     // The header goes in with the first row
+};
+
+// Per-room Stats for one player, in DISPLAY_ORDER, times in seconds
+// "Total Points" and "PPH" have no per-room samples and are left to exportPoints
+// Rooms without a valid sample get null (JSON) / an empty field (CSV) for
+// everything but count and discarded
+void exportStats(ExportTable& t, const std::string& user, const std::map<std::string, Stats>& stats);
+
+// Best, average and most recent points and PPH from computePointsStats
+void exportPoints(ExportTable& t, const std::string& user, const PointsAggregate& agg);
+
+void exportRoomPPH(ExportTable& t, const std::vector<RoomPPHResult>& rows);
+
+// Raids by number of prep rooms (5, 6, anything else)
+void exportLayouts(ExportTable& t, const RoomDistribution& rd);
+
+// Every row of the three layout groups, tagged "layout", "pair" or "family"
+// mask is the PrepMask, bit i = prep room i
+void exportLayoutStats(ExportTable& t, const LayoutAnalysis& layouts);
+
+// One row per room of a computeLastNStats result; rooms the window never
+// sampled get a null / empty avg instead of 0
+void exportLastN(ExportTable& t, int n, const std::map<std::string, double>& avgs);
+
+void exportDiscarded(ExportTable& t, const std::string& user,
+    const DiscardedOutliers& discarded);
+
+// Writes both files; false (and a message on stderr) if either fails
+bool writeExportTable(const std::string& directory, const std::string& name, const ExportTable& t);
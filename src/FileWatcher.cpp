@@ -0,0 +1,155 @@
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "FileWatcher.h"
+
+// Directory to watch and file name to match; plugins may replace files,
+// so the directory is watched rather than the file itself
+static void splitPath(const std::string& path, std::filesystem::path& dir, std::string& name)
+{
+    std::filesystem::path p(path);
+    dir = p.has_parent_path() ? p.parent_path() : std::filesystem::path(".");
+    name = p.filename().string();
+}
+
+#if defined(_WIN32)
+
+FileWatcher::FileWatcher() = default;
+
+FileWatcher::~FileWatcher()
+{
+    for (void* h : handles)
+        FindCloseChangeNotification(static_cast<HANDLE>(h));
+}
+
+bool FileWatcher::add(const std::string& path)
+{
+    std::filesystem::path dir;
+    std::string name;
+    splitPath(path, dir, name);
+
+    const std::string key = dir.string();
+    for (const auto& d : dirs)
+        if (d == key)
+            return true;
+
+    HANDLE h = FindFirstChangeNotificationW(dir.wstring().c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+
+    handles.push_back(h);
+    dirs.push_back(key);
+    return true;
+}
+
+bool FileWatcher::wait(int timeoutMs)
+{
+    if (handles.empty())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        return true;
+    }
+
+    DWORD r = WaitForMultipleObjects(static_cast<DWORD>(handles.size()),
+        handles.data(), FALSE, static_cast<DWORD>(timeoutMs));
+    if (r >= WAIT_OBJECT_0 && r < WAIT_OBJECT_0 + handles.size())
+    {
+        FindNextChangeNotification(static_cast<HANDLE>(handles[r - WAIT_OBJECT_0]));
+        return true;
+    }
+    return false;
+}
+
+#elif defined(__linux__)
+
+FileWatcher::FileWatcher()
+{
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+bool FileWatcher::add(const std::string& path)
+{
+    if (fd < 0)
+        return false;
+
+    std::filesystem::path dir;
+    std::string name;
+    splitPath(path, dir, name);
+
+    int wd = inotify_add_watch(fd, dir.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0)
+        return false;
+
+    watches.push_back({ wd, name });
+    return true;
+}
+
+bool FileWatcher::wait(int timeoutMs)
+{
+    if (fd < 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        return true;
+    }
+
+    pollfd pfd{ fd, POLLIN, 0 };
+    if (poll(&pfd, 1, timeoutMs) <= 0)
+        return false;
+
+    // Drain everything queued; only events on our file names count
+    bool changed = false;
+    alignas(inotify_event) char buf[4096];
+    ssize_t len;
+    while ((len = read(fd, buf, sizeof(buf))) > 0)
+    {
+        for (char* p = buf; p < buf + len; )
+        {
+            auto* ev = reinterpret_cast<inotify_event*>(p);
+            if (ev->len > 0)
+            {
+                for (const auto& w : watches)
+                    if (w.wd == ev->wd && w.name == ev->name)
+                        changed = true;
+            }
+            p += sizeof(inotify_event) + ev->len;
+        }
+    }
+    return changed;
+}
+
+#else
+
+FileWatcher::FileWatcher() = default;
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::add(const std::string&)
+{
+    return true;
+}
+
+bool FileWatcher::wait(int timeoutMs)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    return true;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Waits for writes to a small set of input files
+// Uses inotify on Linux and directory change notifications on Windows;
+// anywhere else wait() simply sleeps and reports a possible change
+struct FileWatcher
+{
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool add(const std::string& path);
+
+    // Blocks until a watched file may have changed (true) or timeoutMs passed (false)
+    // Callers re-check the files after either result, so a spurious true is
+    // harmless and a missed notification only delays the update by timeoutMs
+    bool wait(int timeoutMs);
+
+private:
+#if defined(_WIN32)
+    std::vector<void*> handles;         // One change notification per directory
+    std::vector<std::string> dirs;
+#elif defined(__linux__)
+    struct Watch
+    {
+        int wd;
+        std::string name;
+    };
+    int fd = -1;
+    std::vector<Watch> watches;
+#endif
+};
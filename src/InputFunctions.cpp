@@ -3,8 +3,15 @@
 #include <fstream>
 #include <filesystem>
 #include <cctype>
+#include <charconv>
+#include <string_view>
 
 #include "InputFunctions.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "Profiler.h"
+
+constexpr size_t PARALLEL_PARSE_CHUNK_BYTES = 1 << 20;  // Smallest slice worth its own worker
 
 
 std::string getUsername(const std::string& path) {
@@ -16,7 +23,45 @@ std::string getUsername(const std::string& path) {
     return name;
 }
 
-bool readRaids(const std::string& filename, std::vector<Raid>& raids) {
+// Same rule as loadPrimary: a "CoX KC:" line closes a solo raid that has
+// both a completion time and a floor 1 time
+static void addJoinKey(std::vector<PrimaryRaid>* joinKeys, int kc, const Raid& raid)
+{
+    if (!joinKeys)
+        return;
+
+    if (raid.has(Room::RaidCompleted) && raid.has(Room::Floor1))
+        joinKeys->push_back({ kc, raid.get(Room::RaidCompleted), raid.get(Room::Floor1) });
+}
+
+// Stores a parsed time under its room; untracked labels and the
+// points rows are ignored
+static void setRoomTime(Raid& raid, std::string_view label, int seconds)
+{
+    Room room = roomFromName(label);
+    if (room == Room::Count || room == Room::TotalPoints || room == Room::PPH)
+        return;
+    raid.set(room, seconds);
+}
+
+// "... | Team Size: <n>" with n accepted by the query
+static bool teamSizeAccepted(std::string_view line, const RaidQuery& query)
+{
+    size_t pos = line.find("Team Size: ");
+    if (pos == std::string_view::npos)
+        return false;
+    pos += 11;
+
+    size_t end = pos;
+    while (end < line.size() && std::isdigit(static_cast<unsigned char>(line[end])))
+        ++end;
+    int size = 0;
+    return std::from_chars(line.data() + pos, line.data() + end, size).ec == std::errc()
+        && query.acceptsTeamSize(size);
+}
+
+static bool readRaidsStream(const std::string& filename, std::vector<Raid>& raids, std::vector<PrimaryRaid>* joinKeys,
+    const RaidQuery& query) {
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Cannot open file: " << filename << "\n";
@@ -24,12 +69,15 @@ bool readRaids(const std::string& filename, std::vector<Raid>& raids) {
     }
 
     raids.clear();
-    std::map<std::string, int> currentTimes;
+    if (joinKeys) joinKeys->clear();
+    Raid current;
     int currentKC = 0;
     std::string line;
     bool validRaid = false;
+    int64_t bytes = 0;
 
     while (std::getline(file, line)) {
+        bytes += static_cast<int64_t>(line.size()) + 1;
         if (line.empty()) continue;
 
         size_t kcPos = line.find("KC");
@@ -51,21 +99,25 @@ bool readRaids(const std::string& filename, std::vector<Raid>& raids) {
             }
             if (!num.empty())
                 currentKC = std::stoi(num);
+
+            if (line.rfind("CoX KC:", 0) == 0)
+                addJoinKey(joinKeys, currentKC, current);
         }
 
         if (line.find("---") != std::string::npos) {
-            if (validRaid && !currentTimes.empty()) {
+            current.kc = currentKC;
+            if (validRaid && current.present != 0 && query.acceptsRaid(current)) {
                 //std::cout << "Debug: Adding raid KC " << currentKC << "\n";  // Debug line
-                raids.push_back({ currentKC, currentTimes });
+                raids.push_back(current);
             }
-            currentTimes.clear();
+            current = Raid{};
             currentKC = 0;
             validRaid = false;
             continue;
         }
 
         if (line.find("Raid Completed:") != std::string::npos) {
-            if (line.find("Team Size: " + std::to_string(1)) != std::string::npos) {
+            if (teamSizeAccepted(line, query)) {
                 validRaid = true;
                 size_t pos = line.find("Raid Completed: ") + 16;
                 size_t endPos = line.find(" |", pos);
@@ -79,7 +131,7 @@ bool readRaids(const std::string& filename, std::vector<Raid>& raids) {
                     }
                     catch (...) {}
                 }
-                if (seconds > 0) currentTimes["Raid Completed"] = seconds;
+                if (seconds > 0) current.set(Room::RaidCompleted, seconds);
             }
             continue;
         }
@@ -96,9 +148,229 @@ bool readRaids(const std::string& filename, std::vector<Raid>& raids) {
                 }
                 catch (...) {}
             }
-            if (seconds > 0) currentTimes[key] = seconds;
+            if (seconds > 0) setRoomTime(current, key, seconds);
         }
     }
 
+    profileCount("bytes parsed", bytes);
     return !raids.empty();
-}
\ No newline at end of file
+}
+
+// Same rules as std::stoi: leading whitespace, optional sign, then digits
+static bool parseLeadingInt(std::string_view s, int& out)
+{
+    size_t pos = 0;
+    while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos])))
+        ++pos;
+
+    bool negative = false;
+    if (pos < s.size() && (s[pos] == '+' || s[pos] == '-')) {
+        negative = s[pos] == '-';
+        ++pos;
+    }
+
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(s.data() + pos, s.data() + s.size(), value);
+    if (ec != std::errc() || ptr == s.data() + pos)
+        return false;
+
+    out = negative ? -value : value;
+    return true;
+}
+
+// "m:ss" or "m:ss.d" -> seconds, 0 when either half does not parse
+static int parseMinSec(std::string_view s)
+{
+    size_t colon = s.find(':');
+    if (colon == std::string_view::npos)
+        return 0;
+
+    int m = 0, sec = 0;
+    if (!parseLeadingInt(s.substr(0, colon), m) || !parseLeadingInt(s.substr(colon + 1), sec))
+        return 0;
+    return m * 60 + sec;
+}
+
+// Scans the text in place; lines are views into it and numbers go
+// through from_chars, so nothing is allocated per line.
+// Keeps the exact rules of the stream parser above.
+// Sequential scan; parser state is only carried between "---" lines
+static ParseResume parseRaidsChunk(std::string_view text, std::vector<Raid>& raids, std::vector<PrimaryRaid>* joinKeys,
+    const RaidQuery& query) {
+    ParseResume resume;
+    const size_t raidsBefore = raids.size();
+    const size_t keysBefore = joinKeys ? joinKeys->size() : 0;
+
+    Raid current;
+    int currentKC = 0;
+    bool validRaid = false;
+
+    size_t lineStart = 0;
+
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) lineEnd = text.size();
+        std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        if (line.empty()) continue;
+
+        size_t kcPos = line.find("KC");
+        if (kcPos != std::string_view::npos)
+        {
+            size_t pos = kcPos + 2;
+            while (pos < line.size() && !std::isdigit(static_cast<unsigned char>(line[pos])))
+                ++pos;
+
+            bool hasDigits = false;
+            int kc = 0;
+            while (pos < line.size() && (std::isdigit(static_cast<unsigned char>(line[pos])) || line[pos] == ','))
+            {
+                if (line[pos] != ',') {
+                    kc = kc * 10 + (line[pos] - '0');
+                    hasDigits = true;
+                }
+                ++pos;
+            }
+            if (hasDigits)
+                currentKC = kc;
+
+            if (line.substr(0, 7) == "CoX KC:")
+                addJoinKey(joinKeys, currentKC, current);
+        }
+
+        if (line.find("---") != std::string_view::npos) {
+            current.kc = currentKC;
+            if (validRaid && current.present != 0 && query.acceptsRaid(current)) {
+                raids.push_back(current);
+            }
+            current = Raid{};
+            currentKC = 0;
+            validRaid = false;
+
+            // Parser state is fully reset here, so a later parse can start
+            // from the next line (only once the separator line is complete)
+            if (lineEnd < text.size()) {
+                resume.offset = lineStart;
+                resume.records = raids.size() - raidsBefore;
+                resume.keys = joinKeys ? joinKeys->size() - keysBefore : 0;
+            }
+            continue;
+        }
+
+        if (line.find("Raid Completed:") != std::string_view::npos) {
+            if (teamSizeAccepted(line, query)) {
+                validRaid = true;
+                size_t pos = line.find("Raid Completed: ") + 16;
+                if (pos > line.size()) pos = line.size();
+                size_t endPos = line.find(" |", pos);
+                if (endPos == std::string_view::npos) endPos = line.size();
+                int seconds = parseMinSec(line.substr(pos, endPos - pos));
+                if (seconds > 0) current.set(Room::RaidCompleted, seconds);
+            }
+            continue;
+        }
+
+        size_t colon = line.find(':');
+        if (colon != std::string_view::npos && colon + 1 < line.size()) {
+            int seconds = parseMinSec(line.substr(colon + 2));
+            if (seconds > 0) setRoomTime(current, line.substr(0, colon), seconds);
+        }
+    }
+
+    return resume;
+}
+
+// Start of the line after the first "---" line at or after pos, so a chunk
+// begins where the sequential parser has just reset its state
+static size_t nextChunkStart(std::string_view text, size_t pos)
+{
+    if (pos > 0) {
+        size_t nl = text.find('\n', pos - 1);
+        if (nl == std::string_view::npos) return text.size();
+        pos = nl + 1;
+    }
+
+    while (pos < text.size()) {
+        size_t lineEnd = text.find('\n', pos);
+        if (lineEnd == std::string_view::npos) return text.size();
+        if (text.substr(pos, lineEnd - pos).find("---") != std::string_view::npos)
+            return lineEnd + 1;
+        pos = lineEnd + 1;
+    }
+    return text.size();
+}
+
+ParseResume parseRaidsText(std::string_view text, std::vector<Raid>& raids, std::vector<PrimaryRaid>* joinKeys,
+    const RaidQuery* query) {
+    profileCount("bytes parsed", static_cast<int64_t>(text.size()));
+    const RaidQuery& q = query ? *query : DEFAULT_RAID_QUERY;
+
+    const size_t chunks = std::min<size_t>(defaultThreadCount(), text.size() / PARALLEL_PARSE_CHUNK_BYTES);
+    if (chunks < 2)
+        return parseRaidsChunk(text, raids, joinKeys, q);
+
+    std::vector<size_t> starts{ 0 };
+    for (size_t k = 1; k < chunks; ++k) {
+        size_t start = nextChunkStart(text, text.size() * k / chunks);
+        if (start > starts.back() && start < text.size())
+            starts.push_back(start);
+    }
+    starts.push_back(text.size());
+
+    const size_t n = starts.size() - 1;
+    std::vector<std::vector<Raid>> chunkRaids(n);
+    std::vector<std::vector<PrimaryRaid>> chunkKeys(n);
+    std::vector<ParseResume> chunkResume(n);
+
+    parallelFor(n, [&](size_t k) {
+        chunkResume[k] = parseRaidsChunk(text.substr(starts[k], starts[k + 1] - starts[k]),
+            chunkRaids[k], joinKeys ? &chunkKeys[k] : nullptr, q);
+    });
+
+    // Concatenate in file order; the resume point is the last chunk's one
+    // (every chunk but the last ends on a separator line)
+    ParseResume resume;
+    size_t raidCount = 0, keyCount = 0;
+    for (size_t k = 0; k < n; ++k) {
+        if (chunkResume[k].offset > 0) {
+            resume.offset = starts[k] + chunkResume[k].offset;
+            resume.records = raidCount + chunkResume[k].records;
+            resume.keys = keyCount + chunkResume[k].keys;
+        }
+        raidCount += chunkRaids[k].size();
+        keyCount += chunkKeys[k].size();
+    }
+
+    raids.reserve(raids.size() + raidCount);
+    for (auto& c : chunkRaids)
+        raids.insert(raids.end(), c.begin(), c.end());
+    if (joinKeys) {
+        joinKeys->reserve(joinKeys->size() + keyCount);
+        for (auto& c : chunkKeys)
+            joinKeys->insert(joinKeys->end(), c.begin(), c.end());
+    }
+    return resume;
+}
+
+static bool readRaidsMapped(const std::string& filename, std::vector<Raid>& raids, std::vector<PrimaryRaid>* joinKeys,
+    const RaidQuery* query) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Cannot open file: " << filename << "\n";
+        return false;
+    }
+
+    raids.clear();
+    if (joinKeys) joinKeys->clear();
+    parseRaidsText(file.view(), raids, joinKeys, query);
+
+    return !raids.empty();
+}
+
+bool readRaids(const std::string& filename, std::vector<Raid>& raids, ParserMode mode,
+    std::vector<PrimaryRaid>* joinKeys, const RaidQuery* query) {
+    if (mode == ParserMode::Stream)
+        return readRaidsStream(filename, raids, joinKeys, query ? *query : DEFAULT_RAID_QUERY);
+    return readRaidsMapped(filename, raids, joinKeys, query);
+}
@@ -1,7 +1,19 @@
 #pragma once
 
 #include "Types.h"
+#include "PointsLoader.h"
+#include "RaidQuery.h"
 
 std::string getUsername(const std::string& path);
 
-bool readRaids(const std::string& filename, std::vector<Raid>& raids);
\ No newline at end of file
+// When joinKeys is given, the points join keys (kc, raid and floor 1 seconds)
+// are collected in the same scan, so the primary file is only read once
+// Raids the query rejects are dropped as they are parsed (nullptr = DEFAULT_RAID_QUERY);
+// their join keys are still collected so the points join sees the whole file
+bool readRaids(const std::string& filename, std::vector<Raid>& raids, ParserMode mode = ParserMode::Mapped,
+    std::vector<PrimaryRaid>* joinKeys = nullptr, const RaidQuery* query = nullptr);
+
+// Appends the raids found in text (a whole export or the bytes appended to one)
+// The result says where parsing can resume on the next append
+ParseResume parseRaidsText(std::string_view text, std::vector<Raid>& raids, std::vector<PrimaryRaid>* joinKeys,
+    const RaidQuery* query = nullptr);
\ No newline at end of file
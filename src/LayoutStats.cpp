@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "LayoutStats.h"
+
+LayoutTable::LayoutTable(size_t expected)
+{
+    const size_t capacity = std::bit_ceil(std::max<size_t>(expected * 2, 16));
+    slots.resize(capacity);
+    shift = 32 - std::countr_zero(capacity);
+}
+
+// Fibonacci hashing: the top bits of mask * 2^32/phi spread nearby masks apart
+size_t LayoutTable::slotFor(PrepMask mask) const
+{
+    return static_cast<size_t>((mask * 2654435769u) >> shift);
+}
+
+LayoutAccumulator& LayoutTable::operator[](PrepMask mask)
+{
+    if ((count + 1) * 2 > slots.size())
+        grow();
+
+    const size_t last = slots.size() - 1;
+    size_t i = slotFor(mask);
+    while (slots[i].used && slots[i].mask != mask)
+        i = (i + 1) & last;
+
+    if (!slots[i].used)
+    {
+        slots[i].used = true;
+        slots[i].mask = mask;
+        ++count;
+    }
+    return slots[i];
+}
+
+void LayoutTable::grow()
+{
+    std::vector<LayoutAccumulator> old;
+    old.swap(slots);
+    slots.resize(old.size() * 2);
+    --shift;
+
+    const size_t last = slots.size() - 1;
+    for (const auto& e : old)
+    {
+        if (!e.used)
+            continue;
+        size_t i = slotFor(e.mask);
+        while (slots[i].used)
+            i = (i + 1) & last;
+        slots[i] = e;
+    }
+}
+
+static void accumulate(LayoutAccumulator& a, int seconds, double pph)
+{
+    ++a.raids;
+    if (seconds > 0)
+    {
+        ++a.timedRaids;
+        a.totalSeconds += seconds;
+    }
+    if (pph > 0.0)
+    {
+        ++a.pphRaids;
+        a.totalPPH += pph;
+    }
+}
+
+static std::vector<LayoutResult> collectResults(const LayoutTable& table, int totalRaids)
+{
+    std::vector<LayoutResult> result;
+    result.reserve(table.size());
+
+    for (const auto& a : table.entries())
+    {
+        if (!a.used)
+            continue;
+
+        result.push_back({
+            a.mask,
+            a.raids,
+            totalRaids > 0 ? a.raids * 100.0 / totalRaids : 0.0,
+            a.timedRaids > 0 ? static_cast<int>(std::lround(static_cast<double>(a.totalSeconds) / a.timedRaids)) : 0,
+            a.pphRaids > 0 ? static_cast<int>(a.totalPPH / a.pphRaids) : 0
+            });
+    }
+
+    std::sort(result.begin(), result.end(),
+        [](const LayoutResult& a, const LayoutResult& b)
+        {
+            return a.raids > b.raids || (a.raids == b.raids && a.mask < b.mask);
+        });
+    return result;
+}
+
+LayoutAnalysis computeLayoutAnalysis(const RaidTable& table)
+{
+    LayoutTable layouts, pairs(PREP_ROOM_COUNT * (PREP_ROOM_COUNT - 1) / 2), families;
+
+    const int32_t* points = table.totalPoints.data();
+    const int32_t* seconds = table.totalSeconds.data();
+
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        const PrepMask mask = prepMask(table.layout[i]);
+        const double pph = (points[i] > 0 && seconds[i] > 0) ? points[i] / (seconds[i] / 3600.0) : 0.0;
+
+        accumulate(layouts[mask], seconds[i], pph);
+        accumulate(families[static_cast<PrepMask>(mask & PUZZLE_ROOM_MASK)], seconds[i], pph);
+
+        // Each set bit paired with every higher one
+        for (uint32_t low = mask; low; low &= low - 1)
+        {
+            const uint32_t lowBit = low & (0u - low);
+            for (uint32_t high = low & (low - 1); high; high &= high - 1)
+                accumulate(pairs[static_cast<PrepMask>(lowBit | (high & (0u - high)))], seconds[i], pph);
+        }
+    }
+
+    LayoutAnalysis out;
+    out.raids = static_cast<int>(table.size());
+    out.layouts = collectResults(layouts, out.raids);
+    out.pairs = collectResults(pairs, out.raids);
+    out.families = collectResults(families, out.raids);
+    return out;
+}
+
+std::string layoutLabel(PrepMask mask, const char* separator)
+{
+    std::string label;
+    for (uint32_t m = mask; m; m &= m - 1)
+    {
+        if (!label.empty())
+            label += separator;
+        label += ROOM_NAMES[std::countr_zero(m)];
+    }
+    return label;
+}
+
+std::string familyLabel(PrepMask mask)
+{
+    return mask ? layoutLabel(mask) : "No puzzles";
+}
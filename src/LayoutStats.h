@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Types.h"
+
+// Running totals for the raids counted under one prep mask
+struct LayoutAccumulator
+{
+    PrepMask mask = 0;
+    bool used = false;
+    int raids = 0;
+    int timedRaids = 0;         // Raids with a total time
+    int64_t totalSeconds = 0;
+    int pphRaids = 0;           // Raids with points and a total time
+    double totalPPH = 0.0;
+};
+
+// Flat open-addressing table keyed by prep mask (linear probing,
+// power-of-two capacity kept at most half full)
+// Real logs only show a few hundred distinct masks, so every lookup
+// is a multiply, a shift and usually one probe
+struct LayoutTable
+{
+    explicit LayoutTable(size_t expected = 64);
+
+    LayoutAccumulator& operator[](PrepMask mask);
+
+    size_t size() const { return count; }
+    const std::vector<LayoutAccumulator>& entries() const { return slots; }   // Unused slots included
+
+private:
+    size_t slotFor(PrepMask mask) const;
+    void grow();
+
+    std::vector<LayoutAccumulator> slots;
+    size_t count = 0;
+    int shift = 0;              // 32 - log2(capacity)
+};
+
+// One row of a layout table
+struct LayoutResult
+{
+    PrepMask mask;
+    int raids;
+    double percent;             // Share of all raids
+    int avgSeconds;             // 0 when no raid had a total time
+    int avgPPH;                 // 0 when no raid had points
+};
+
+// Raids grouped three ways, each group sorted by raids (most first)
+struct LayoutAnalysis
+{
+    int raids = 0;
+    std::vector<LayoutResult> layouts;      // Exact prep-room set
+    std::vector<LayoutResult> pairs;        // Every two prep rooms met in the same raid
+    std::vector<LayoutResult> families;     // Puzzle rooms of the layout (mask & PUZZLE_ROOM_MASK)
+};
+
+LayoutAnalysis computeLayoutAnalysis(const RaidTable& table);
+
+// Room names in the mask, in registry order, e.g. "Tekton, Crabs, Vasa"
+std::string layoutLabel(PrepMask mask, const char* separator = ", ");
+
+// Same, but "No puzzles" for an empty puzzle set
+std::string familyLabel(PrepMask mask);
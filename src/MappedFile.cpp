@@ -0,0 +1,119 @@
+#include <filesystem>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    std::wstring widePath = std::filesystem::path(path).wstring();
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    // Zero-length files cannot be mapped; an empty view is still a valid open
+    if (size == 0)
+        return true;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    mappingHandle = mapping;
+
+    data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data)
+        UnmapViewOfFile(data);
+    if (mappingHandle)
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle)
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+
+    size = static_cast<size_t>(st.st_size);
+    if (size == 0)
+        return true;
+
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+    madvise(p, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(p);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data)
+        munmap(const_cast<char*>(data), size);
+    if (fd >= 0)
+        ::close(fd);
+
+    data = nullptr;
+    size = 0;
+    fd = -1;
+}
+
+#endif
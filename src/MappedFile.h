@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole input file
+// The mapping lives as long as the object; views into it must not outlive it
+struct MappedFile
+{
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    std::string_view view() const { return { data, size }; }
+
+    const char* data = nullptr;
+    size_t size = 0;
+
+private:
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
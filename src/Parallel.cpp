@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Parallel.h"
+
+// Set on pool threads so a nested parallelFor runs inline instead of
+// multiplying threads (e.g. a chunked parse inside --compare)
+static thread_local bool insideWorker = false;
+
+unsigned defaultThreadCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void parallelFor(size_t count, const std::function<void(size_t)>& fn, unsigned threads)
+{
+    if (count == 0)
+        return;
+
+    if (threads == 0)
+        threads = defaultThreadCount();
+    const size_t workers = std::min<size_t>(threads, count);
+
+    // Not worth a thread, or already on one
+    if (workers == 1 || insideWorker)
+    {
+        for (size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next{ 0 };
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto work = [&]() {
+        const bool wasInside = insideWorker;
+        insideWorker = true;
+        for (size_t i = next++; i < count; i = next++)
+        {
+            try {
+                fn(i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+                next = count;   // Stop handing out work
+            }
+        }
+        insideWorker = wasInside;
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t t = 1; t < workers; ++t)
+        pool.emplace_back(work);
+    work();     // The calling thread takes a share too
+
+    for (auto& t : pool)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
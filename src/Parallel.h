@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Worker threads used when a caller passes 0: the hardware thread count
+unsigned defaultThreadCount();
+
+// Runs fn(0) .. fn(count - 1) on up to `threads` workers (0 = default)
+// Workers pull the next index from a shared counter, so uneven tasks
+// balance out. Returns once every call finished; the first exception
+// thrown by fn is rethrown here. Called from inside a worker it runs inline.
+void parallelFor(size_t count, const std::function<void(size_t)>& fn, unsigned threads = 0);
@@ -1,4 +1,22 @@
-﻿#include "PointsLoader.h"
+﻿#include <bit>
+#include <optional>
+#include <charconv>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COX_SCAN_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COX_SCAN_SSE2 1
+#endif
+
+#include "PointsLoader.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include "RaidQuery.h"
 
 int parseTimeMMSS(const std::string& s)
 {
@@ -34,6 +52,132 @@ bool extractBool(const std::string& line, const std::string& key, bool& out)
     return true;
 }
 
+enum class PointsField
+{
+    ChallengeMode, TeamSize, RaidTime, UpperTime, TotalPoints, CompletionCount, Date, Count
+};
+
+struct PointsKey
+{
+    std::string_view name;
+    PointsField field;
+};
+
+constexpr PointsKey POINTS_KEYS[] = {
+    { "challengeMode",   PointsField::ChallengeMode },
+    { "teamSize",        PointsField::TeamSize },
+    { roomInfo(Room::RaidCompleted).trackerKey, PointsField::RaidTime },
+    { roomInfo(Room::Floor1).trackerKey,        PointsField::UpperTime },
+    { roomInfo(Room::TotalPoints).trackerKey,   PointsField::TotalPoints },
+    { "completionCount", PointsField::CompletionCount },
+    { "date",            PointsField::Date },
+};
+
+constexpr unsigned ALL_POINTS_FIELDS = (1u << static_cast<unsigned>(PointsField::Count)) - 1;
+
+template <typename T>
+static void parseJsonInt(const char* p, const char* end, T& out)
+{
+    while (p < end && *p == ' ') ++p;
+    if (p < end && *p == '+') ++p;
+    T value{};
+    if (std::from_chars(p, end, value).ec == std::errc())
+        out = value;
+}
+
+// Called for every '"' in the line; checks whether a wanted key starts
+// right after it and, if so, reads the value behind the colon
+static void matchKeyAt(const char* line, size_t n, size_t quote, PointsLine& out, unsigned& found)
+{
+    const size_t k = quote + 1;
+    if (k >= n)
+        return;
+
+    for (const auto& key : POINTS_KEYS)
+    {
+        if (line[k] != key.name[0])
+            continue;
+
+        const size_t len = key.name.size();
+        if (k + len >= n || line[k + len] != '"' || std::memcmp(line + k, key.name.data(), len) != 0)
+            continue;
+
+        const unsigned bit = 1u << static_cast<unsigned>(key.field);
+        if (found & bit)
+            return;
+
+        size_t v = k + len + 1;
+        while (v < n && line[v] == ' ') ++v;
+        if (v >= n || line[v] != ':')
+            return;
+        ++v;
+
+        const char* p = line + v;
+        const char* end = line + n;
+        switch (key.field)
+        {
+        case PointsField::ChallengeMode:
+            out.challengeMode = std::string_view(p, std::min<size_t>(5, n - v)).find("true") != std::string_view::npos;
+            break;
+        case PointsField::TeamSize:        parseJsonInt(p, end, out.teamSize); break;
+        case PointsField::RaidTime:        parseJsonInt(p, end, out.raidTime); break;
+        case PointsField::UpperTime:       parseJsonInt(p, end, out.upperTime); break;
+        case PointsField::TotalPoints:     parseJsonInt(p, end, out.totalPoints); break;
+        case PointsField::CompletionCount: parseJsonInt(p, end, out.completionCount); break;
+        case PointsField::Date:            parseJsonInt(p, end, out.date); break;
+        default: break;
+        }
+        found |= bit;
+        return;
+    }
+}
+
+void scanPointsLine(std::string_view line, PointsLine& out)
+{
+    const char* p = line.data();
+    const size_t n = line.size();
+    unsigned found = 0;
+    size_t i = 0;
+
+    // Vector part: compare a block against '"' and visit each set bit
+#if COX_SCAN_AVX2
+    const __m256i quote = _mm256_set1_epi8('"');
+    for (; i + 32 <= n && found != ALL_POINTS_FIELDS; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, quote)));
+        while (mask)
+        {
+            matchKeyAt(p, n, i + std::countr_zero(mask), out, found);
+            mask &= mask - 1;
+        }
+    }
+#elif COX_SCAN_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    for (; i + 16 <= n && found != ALL_POINTS_FIELDS; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, quote)));
+        while (mask)
+        {
+            matchKeyAt(p, n, i + std::countr_zero(mask), out, found);
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // Scalar tail (or the whole line without SIMD)
+    while (i < n && found != ALL_POINTS_FIELDS)
+    {
+        const void* q = std::memchr(p + i, '"', n - i);
+        if (!q)
+            break;
+        size_t pos = static_cast<const char*>(q) - p;
+        matchKeyAt(p, n, pos, out, found);
+        i = pos + 1;
+    }
+}
+
 std::vector<PrimaryRaid> loadPrimary(const std::string& path)
 {
     std::ifstream file(path);
@@ -78,35 +222,48 @@ std::vector<PrimaryRaid> loadPrimary(const std::string& path)
     return raids;
 }
 
-std::vector<PointsRaid> loadPointsFile(const std::string& path)
+ParseResume parsePointsText(std::string_view text, std::vector<PointsRaid>& raids, const RaidQuery* query)
 {
-    std::ifstream file(path);
-    std::string line;
+    profileCount("bytes parsed", static_cast<int64_t>(text.size()));
+    const RaidQuery& q = query ? *query : DEFAULT_RAID_QUERY;
 
-    std::vector<PointsRaid> raids;
+    ParseResume resume;
+    const size_t before = raids.size();
+    size_t lineStart = 0;
 
-    while (std::getline(file, line))
+    while (lineStart < text.size())
     {
-        bool challenge = true;
-        int teamSize = -1;
-        int raidTime = -1;
-        int upperTime = -1;
-        int totalPoints = -1;
-
-        extractBool(line, "\"challengeMode\"", challenge);
-        extractInt(line, "\"teamSize\"", teamSize);
+        size_t lineEnd = text.find('\n', lineStart);
+        const bool complete = lineEnd != std::string_view::npos;
+        if (!complete) lineEnd = text.size();
+        std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
 
-        if (challenge || teamSize != 1)
-            continue;
+        PointsLine f;
+        scanPointsLine(line, f);
 
-        extractInt(line, "\"raidTime\"", raidTime);
-        extractInt(line, "\"upperTime\"", upperTime);
-        extractInt(line, "\"totalPoints\"", totalPoints);
+        if (f.raidTime > 0 && f.upperTime > 0 && f.totalPoints > 0 && q.acceptsTeamSize(f.teamSize))
+            raids.push_back({ f.raidTime, f.upperTime, f.totalPoints, f.completionCount, f.date, f.challengeMode });
 
-        if (raidTime > 0 && upperTime > 0 && totalPoints > 0)
-            raids.push_back({ raidTime, upperTime, totalPoints });
+        // A line without its newline may still be half written
+        if (complete)
+        {
+            resume.offset = lineStart;
+            resume.records = raids.size() - before;
+        }
     }
 
+    return resume;
+}
+
+std::vector<PointsRaid> loadPointsFile(const std::string& path, const RaidQuery* query)
+{
+    MappedFile file;
+    std::vector<PointsRaid> raids;
+    if (!file.open(path))
+        return raids;
+
+    parsePointsText(file.view(), raids, query);
     return raids;
 }
 
@@ -114,40 +271,158 @@ std::map<int, int> loadPoints(
     const std::string& primaryPath,
     const std::string& pointsPath)
 {
-    auto primary = loadPrimary(primaryPath);
-    auto points = loadPointsFile(pointsPath);
+    return loadPoints(loadPrimary(primaryPath), pointsPath);
+}
 
-    std::map<int, int> result;
+std::map<int, int> loadPoints(
+    const std::vector<PrimaryRaid>& primary,
+    const std::string& pointsPath)
+{
+    return matchPoints(primary, loadPointsFile(pointsPath));
+}
 
-    int i = (int)primary.size() - 1;
-    int j = (int)points.size() - 1;
+constexpr int JOIN_TOLERANCE = 3;          // Seconds either way on raid and upper floor time
+constexpr int JOIN_CELL = JOIN_TOLERANCE + 1;   // Bucket width; a match is at most one bucket away
+constexpr int JOIN_MAX_GAP = 32;           // How far back an ambiguous pick may be from the previous match
+constexpr size_t JOIN_INDEX_BYTES_PER_ENTRY = 160;  // Rough arena use of the index per points entry
 
-    constexpr int TOL = 3;
+static uint64_t joinCell(int raidSeconds, int upperSeconds)
+{
+    const auto a = static_cast<uint32_t>(raidSeconds / JOIN_CELL);
+    const auto b = static_cast<uint32_t>(upperSeconds / JOIN_CELL);
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
 
-    while (i >= 0 && j >= 0)
+static bool timesMatch(const PrimaryRaid& p, const PointsRaid& q)
+{
+    return std::abs(p.raidSeconds - q.raidSeconds) <= JOIN_TOLERANCE
+        && std::abs(p.floor1Seconds - q.upperSeconds) <= JOIN_TOLERANCE;
+}
+
+std::map<int, int> matchPoints(
+    const std::vector<PrimaryRaid>& primary,
+    const std::vector<PointsRaid>& points,
+    JoinStats* stats,
+    Arena* scratch,
+    const RaidQuery* query)
+{
+    const RaidQuery& filter = query ? *query : DEFAULT_RAID_QUERY;
+    JoinStats js;
+    js.primary = static_cast<int>(primary.size());
+
+    std::optional<Arena> localArena;
+    if (!scratch)
+        scratch = &localArena.emplace(std::max<size_t>(points.size() * JOIN_INDEX_BYTES_PER_ENTRY, ARENA_FIRST_BLOCK_BYTES));
+    std::pmr::memory_resource* mem = scratch->resource();
+
+    // Index every points entry by time bucket and by completion counter;
+    // a repeated date is the same raid logged twice
+    std::pmr::unordered_map<uint64_t, std::pmr::vector<int>> byTime(mem);
+    std::pmr::unordered_map<int, int> byCompletion(mem);
+    std::pmr::unordered_set<int64_t> dates(mem);
+    std::pmr::vector<char> used(points.size(), 0, mem);
+
+    byTime.reserve(points.size());
+    for (int j = 0; j < static_cast<int>(points.size()); ++j)
     {
-        const auto& p = primary[i];
         const auto& q = points[j];
+        if (q.date >= 0 && !dates.insert(q.date).second)
+        {
+            used[j] = 1;
+            ++js.duplicates;
+            continue;
+        }
+        byTime[joinCell(q.raidSeconds, q.upperSeconds)].push_back(j);
+        if (q.completionCount >= 0)
+            byCompletion.emplace(q.completionCount, j);
+    }
 
-        bool raidMatch = std::abs(p.raidSeconds - q.raidSeconds) <= TOL;
-        bool floorMatch = std::abs(p.floor1Seconds - q.upperSeconds) <= TOL;
+    std::map<int, int> result;
 
-        if (raidMatch && floorMatch)
+    // Walk from the newest raid back; both files are in raid order, so the
+    // previous match says roughly where the next one should be
+    int last = static_cast<int>(points.size());
+    bool haveOffset = false;
+    int completionOffset = 0;               // kc - completionCount, learned from a time match
+    std::pmr::vector<int> candidates(mem);
+
+    for (int i = static_cast<int>(primary.size()) - 1; i >= 0; --i)
+    {
+        const auto& p = primary[i];
+        int pick = -1;
+
+        // --- completionCount fast path ---
+        if (haveOffset)
         {
-            result[p.kc] = q.totalPoints;
-            /*std::cout << "Matched KC " << p.kc
-                << " | raid " << p.raidSeconds
-                << " | floor1 " << p.floor1Seconds
-                << " | points " << q.totalPoints << "\n";*/
-            --i;
-            --j;
+            auto it = byCompletion.find(p.kc - completionOffset);
+            if (it != byCompletion.end() && !used[it->second] && timesMatch(p, points[it->second]))
+            {
+                pick = it->second;
+                ++js.byCompletion;
+            }
         }
-        else
+
+        // --- time buckets ---
+        if (pick < 0)
+        {
+            candidates.clear();
+            const int a = p.raidSeconds / JOIN_CELL;
+            const int b = p.floor1Seconds / JOIN_CELL;
+            for (int da = -1; da <= 1; ++da)
+                for (int db = -1; db <= 1; ++db)
+                {
+                    auto it = byTime.find(joinCell((a + da) * JOIN_CELL, (b + db) * JOIN_CELL));
+                    if (it == byTime.end())
+                        continue;
+                    for (int j : it->second)
+                        if (!used[j] && timesMatch(p, points[j]))
+                            candidates.push_back(j);
+                }
+
+            if (candidates.size() == 1)
+            {
+                pick = candidates[0];
+            }
+            else if (candidates.size() > 1)
+            {
+                // Take the nearest entry before the previous match; if none is
+                // within reach the raid stays unmatched rather than guessed
+                for (int j : candidates)
+                    if (j < last && last - j <= JOIN_MAX_GAP && j > pick)
+                        pick = j;
+                if (pick >= 0)
+                    ++js.ambiguous;
+                else
+                    ++js.ambiguousUnmatched;
+            }
+
+            if (pick >= 0 && !haveOffset && candidates.size() == 1 && points[pick].completionCount >= 0)
+            {
+                haveOffset = true;
+                completionOffset = p.kc - points[pick].completionCount;
+            }
+        }
+
+        if (pick < 0)
         {
-            // points file has extra CM runs → skip it
-            --j;
+            ++js.unmatched;
+            continue;
         }
+
+        used[pick] = 1;
+        last = pick;
+        ++js.matched;
+
+        // Filtered only now: dropping the entry before the join could let
+        // this raid take a neighbour's entry instead
+        if (filter.acceptsPoints(points[pick]))
+            result[p.kc] = points[pick].totalPoints;
+        else
+            ++js.rejected;
     }
 
+    js.unusedPoints = static_cast<int>(std::count(used.begin(), used.end(), 0));
+    if (stats)
+        *stats = js;
     return result;
-}
\ No newline at end of file
+}
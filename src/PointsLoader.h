@@ -3,8 +3,13 @@
 #include <fstream>
 #include <cmath>
 #include <cctype>
+#include <cstdint>
+#include <string_view>
 
 #include "Types.h"
+#include "Arena.h"
+
+struct RaidQuery;
 
 struct PrimaryRaid
 {
@@ -18,6 +23,22 @@ struct PointsRaid
     int raidSeconds;
     int upperSeconds;
     int totalPoints;
+    int completionCount = -1;   // Tracker's own completion counter, -1 if missing
+    int64_t date = -1;          // Epoch milliseconds, -1 if missing
+    bool challengeMode = false;
+};
+
+// Fields read from one raid-tracker JSON line
+// Defaults match what loadPointsFile assumed when a key was missing
+struct PointsLine
+{
+    bool challengeMode = true;
+    int teamSize = -1;
+    int raidTime = -1;
+    int upperTime = -1;
+    int totalPoints = -1;
+    int completionCount = -1;
+    int64_t date = -1;
 };
 
 int parseTimeMMSS(const std::string& s);
@@ -28,10 +49,51 @@ bool extractInt(const std::string& line, const std::string& key, int& out);
 
 bool extractBool(const std::string& line, const std::string& key, bool& out);
 
+// Finds all PointsLine keys in one sweep over the line (first occurrence wins)
+void scanPointsLine(std::string_view line, PointsLine& out);
+
 std::vector<PrimaryRaid> loadPrimary(const std::string& path);
 
-std::vector<PointsRaid> loadPointsFile(const std::string& path);
+// Keeps the entries of the query's team size (nullptr = DEFAULT_RAID_QUERY: solo)
+// Mode, date and points are left to matchPoints, so every raid is still
+// joined against its own entry
+std::vector<PointsRaid> loadPointsFile(const std::string& path, const RaidQuery* query = nullptr);
+
+// Appends the complete entries of the query's team size; resumes after the last newline
+ParseResume parsePointsText(std::string_view text, std::vector<PointsRaid>& raids, const RaidQuery* query = nullptr);
 
 std::map<int, int> loadPoints(
     const std::string& primaryPath,
-    const std::string& pointsPath);
\ No newline at end of file
+    const std::string& pointsPath);
+
+// Join against keys already collected by readRaids
+std::map<int, int> loadPoints(
+    const std::vector<PrimaryRaid>& primary,
+    const std::string& pointsPath);
+
+// How the last points join went
+struct JoinStats
+{
+    int primary = 0;        // Raids that needed points
+    int matched = 0;
+    int byCompletion = 0;   // Matched through the learned kc - completionCount offset
+    int ambiguous = 0;      // Had several entries within tolerance; order decided
+    int unmatched = 0;      // Raids left without points
+    int ambiguousUnmatched = 0; // Part of unmatched: several entries, none within JOIN_MAX_GAP
+    int unusedPoints = 0;   // Points entries no raid claimed
+    int duplicates = 0;     // Points entries dropped for a repeated date
+    int rejected = 0;       // Matched, but the entry failed the query (mode, date, points)
+};
+
+// KC -> total points for every primary raid matched to a points entry
+// Entries are found through a hash of (raidTime, upperTime) within +-3 s,
+// so a missing or extra line on either side only affects that one raid
+// The hash index is built in scratch (a local arena when none is given)
+// Raids whose matched entry the query rejects get no points, so later
+// filterRaidsWithPoints drops them (nullptr = DEFAULT_RAID_QUERY: non-CM)
+std::map<int, int> matchPoints(
+    const std::vector<PrimaryRaid>& primary,
+    const std::vector<PointsRaid>& points,
+    JoinStats* stats = nullptr,
+    Arena* scratch = nullptr,
+    const RaidQuery* query = nullptr);
\ No newline at end of file
@@ -1,3 +1,7 @@
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
 #include "PrintFunctions.h"
 #include "ComputeFunctions.h"
 
@@ -6,35 +10,47 @@ struct RowContext {
     const PointsToPrint* pts; // nullptr for normal rows
 };
 
-void printRaidStatisticsHeader(const std::string& primaryUser, const std::string& secondaryUser, bool hasSecondary, int totalWidth, int nPastRaids)
+// Writes value (mm:ss or plain number) into buf and returns the length
+static size_t formatValue(char* buf, int value, bool isTime)
 {
-    std::cout << "Raid Statistics - Primary: " << primaryUser << "\n";
-    std::cout << std::string(totalWidth, '=') << "\n";
+    if (isTime)
+        return formatTime(buf, value);
+    return static_cast<size_t>(std::to_chars(buf, buf + 16, value).ptr - buf);
+}
 
-    std::cout << std::left << std::setw(NW) << "Room" << std::string(SEP, ' ')
-        << std::right << std::setw(TW) << "Best" << std::string(SEP, ' ')
-        << std::right << std::setw(AW) << "Average" << std::string(SEP, ' ')
-        << centerText("Recent", RW) << std::string(SEP, ' ')
-        << centerText("Last " + std::to_string(nPastRaids), LW);
+void printRaidStatisticsHeader(TextBuffer& out, const std::string& primaryUser, const std::string& secondaryUser, bool hasSecondary, int totalWidth, const std::vector<int>& lastNs)
+{
+    out.put("Raid Statistics - Primary: ").put(primaryUser).put('\n');
+    out.repeat('=', totalWidth).put('\n');
+
+    out.left("Room", NW).repeat(' ', SEP)
+        .right("Best", TW).repeat(' ', SEP)
+        .right("Average", AW).repeat(' ', SEP)
+        .center("Recent", RW);
+
+    for (int n : lastNs) {
+        char title[32] = "Last ";
+        char* end = std::to_chars(title + 5, title + sizeof(title), n).ptr;
+        out.repeat(' ', SEP).center(std::string_view(title, static_cast<size_t>(end - title)), LW);
+    }
 
 
     if (hasSecondary)
-        std::cout << std::string(SEP, ' ')
-        << centerText("vs " + secondaryUser, CW);
+        out.repeat(' ', SEP)
+        .center("vs " + secondaryUser, CW);
 
 
-    std::cout << "\n";
-    std::cout << std::string(totalWidth, '-') << "\n";
+    out.put('\n');
+    out.repeat('-', totalWidth).put('\n');
 }
 
-void printStatsTable(const std::map<std::string, Stats>& primaryStats, const std::map<std::string, Stats>& secondaryStats, const std::map<std::string,
+void printStatsTable(TextBuffer& out, const std::map<std::string, Stats>& primaryStats, const std::map<std::string, Stats>& secondaryStats, const std::map<std::string,
     int>& recentVal, const std::string& secondaryUser, int totalWidth, bool hasSecondary, PointsToPrint PPH, PointsToPrint Points,
-    std::map<std::string, double> lastNAvg)
+    const std::vector<std::map<std::string, double>>& lastNAvgs)
 {
     for (const auto& key : DISPLAY_ORDER) {
         auto it = primaryStats.find(key);
         if (it == primaryStats.end()) continue;
-        // 
         const auto& ps = it->second;
 
         RowContext ctx{ false, nullptr };
@@ -48,57 +64,30 @@ void printStatsTable(const std::map<std::string, Stats>& primaryStats, const std
 
         if (ps.validCount == 0 && isPrepRoom(key)) continue;
 
-        std::string bestStr = "--:--";
-        std::string avgStr = "--:--";
+		// Printing starts here
+
+        out.left(key, NW).repeat(' ', SEP);
 
         if (ctx.isPointsRow) {
-            bestStr = std::to_string(ctx.pts->best);
-            avgStr = std::to_string(ctx.pts->average);
+            out.right(ctx.pts->best, TW).repeat(' ', SEP)
+                .right(ctx.pts->average, AW).repeat(' ', SEP);
         }
         else {
-            bestStr = (ps.fastest > 0) ? secondsToTime(ps.fastest) : "--:--";
-            avgStr = secondsToTime(static_cast<int>(std::round(ps.avg)));
-        }
-
-		// Comparison column (if applicable)
-        std::string compStr = "";
-        if (hasSecondary && !ctx.isPointsRow) {
-            if (hasSecondary && !ctx.isPointsRow && secondaryStats.count(key))
-            {
-                auto ssIt = secondaryStats.find(key);
-                if (ssIt != secondaryStats.end()) {
-                    const auto& ss = ssIt->second;
-                    if (ss.avg > 0.5) {
-                        std::string tstr = secondsToTime(static_cast<int>(std::round(ss.avg)));
-                        double diff = ps.avg - ss.avg;
-                        int diffAbs = static_cast<int>(std::round(std::abs(diff)));
-                        std::string dstr = secondsToTime(diffAbs);
-                        std::string sign = (std::abs(diff) < 0.5) ? " " : (diff < 0 ? "-" : "+");
-                        const char* col = diffColor(
-                            static_cast<int>(std::round(diff)),
-                            true,          // time comparison
-                            false          // lower time is better
-                        );
-
-                        compStr = tstr + " " + col + sign + dstr + COLOR_RESET + " (" + std::to_string(ss.validCount) + ")";
-                    }
-                }
-            }
+            if (ps.fastest > 0)
+                out.rightTime(ps.fastest, TW);
+            else
+                out.right("--:--", TW);
+            out.repeat(' ', SEP)
+                .rightTime(static_cast<int>(std::round(ps.avg)), AW).repeat(' ', SEP);
         }
 
-		// Printing starts here
-
-        std::cout << std::left << std::setw(NW) << key << std::string(SEP, ' ')
-            << std::right << std::setw(TW) << bestStr << std::string(SEP, ' ')
-            << std::right << std::setw(AW) << avgStr << std::string(SEP, ' ');
-
         auto printValueCell = [&](bool hasValue, int value, double avg, bool isTime, bool invertColor)
             {
                 if (hasValue) {
-                    printCell(makeCell(value, avg, isTime, invertColor));
+                    printCell(out, value, avg, isTime, invertColor);
                 }
                 else {
-                    std::cout << std::setw(VALUE_W + 1 + DIFF_W) << "-";
+                    out.right("-", VALUE_W + 1 + DIFF_W);
                 }
             };
 
@@ -112,215 +101,382 @@ void printStatsTable(const std::map<std::string, Stats>& primaryStats, const std
             );
         }
         else {
+            auto rv = recentVal.find(key);
             printValueCell(
-                recentVal.count(key),
-                recentVal.count(key) ? recentVal.at(key) : 0,
+                rv != recentVal.end(),
+                rv != recentVal.end() ? rv->second : 0,
                 ps.avg,
                 true,
                 false
             );
         }
 
-        std::cout << std::string(SEP, ' ');
+        for (const auto& lastNAvg : lastNAvgs) {
+            out.repeat(' ', SEP);
 
-        if (ctx.isPointsRow) {
-            printValueCell(
-                lastNAvg.count(key),
-                static_cast<int>(lastNAvg.at(key)),
-                ctx.pts->average,
-                false,
-                true
-            );
-        }
-        else {
-            const bool hasLastN =
-                lastNAvg.count(key) &&
-                static_cast<int>(lastNAvg.at(key)) > 0;
+            auto ln = lastNAvg.find(key);
+            const int lastN = (ln != lastNAvg.end()) ? static_cast<int>(ln->second) : 0;
 
-            printValueCell(
-                hasLastN,
-                hasLastN ? static_cast<int>(lastNAvg.at(key)) : 0,
-                ps.avg,
-                true,
-                false
-            );
+            if (ctx.isPointsRow) {
+                printValueCell(
+                    ln != lastNAvg.end(),
+                    lastN,
+                    ctx.pts->average,
+                    false,
+                    true
+                );
+            }
+            else {
+                const bool hasLastN = ln != lastNAvg.end() && lastN > 0;
+
+                printValueCell(
+                    hasLastN,
+                    lastN,
+                    ps.avg,
+                    true,
+                    false
+                );
+            }
         }
 
-        if (hasSecondary)
-            std::cout << std::string(SEP, ' ') << std::right << std::setw(CW) << compStr;
-        std::cout << "\n";
+		// Comparison column (if applicable)
+        if (hasSecondary) {
+            out.repeat(' ', SEP);
+
+            const Stats* ss = nullptr;
+            if (!ctx.isPointsRow) {
+                auto ssIt = secondaryStats.find(key);
+                if (ssIt != secondaryStats.end() && ssIt->second.avg > 0.5)
+                    ss = &ssIt->second;
+            }
+
+            if (ss) {
+                // "<avg> <color><sign><diff><reset> (<count>)", right-aligned as one string
+                char avgBuf[16], diffBuf[16], countBuf[16];
+                double diff = ps.avg - ss->avg;
+                const size_t avgLen = formatTime(avgBuf, static_cast<int>(std::round(ss->avg)));
+                const size_t diffLen = formatTime(diffBuf, static_cast<int>(std::round(std::abs(diff))));
+                const size_t countLen = static_cast<size_t>(std::to_chars(countBuf, countBuf + sizeof(countBuf), ss->validCount).ptr - countBuf);
+                const char sign = (std::abs(diff) < 0.5) ? ' ' : (diff < 0 ? '-' : '+');
+                const char* col = diffColor(
+                    static_cast<int>(std::round(diff)),
+                    true,          // time comparison
+                    false          // lower time is better
+                );
+
+                const size_t len = avgLen + 1 + std::strlen(col) + 1 + diffLen + std::strlen(COLOR_RESET) + 2 + countLen + 1;
+                out.repeat(' ', CW - static_cast<int>(len))
+                    .put(std::string_view(avgBuf, avgLen)).put(' ')
+                    .put(col).put(sign).put(std::string_view(diffBuf, diffLen)).put(COLOR_RESET)
+                    .put(" (").put(std::string_view(countBuf, countLen)).put(')');
+            }
+            else {
+                out.repeat(' ', CW);
+            }
+        }
+        out.put('\n');
 
         if (key == "Pre-Olm" || key == "Raid Completed" || key == "Between room time")
-            std::cout << std::string(totalWidth, '-') << "\n";
+            out.repeat('-', totalWidth).put('\n');
     }
-    std::cout << std::string(totalWidth, '=') << "\n\n";
+    out.repeat('=', totalWidth).put("\n\n");
 }
 
-void printMostCommonPrepRooms(const std::vector<std::pair<std::string, const Stats*>>& common, int raids5, int raids6, int raidsOther, int totalRaids)
+void printMostCommonPrepRooms(TextBuffer& out, const std::vector<std::pair<std::string, const Stats*>>& common, int raids5, int raids6, int raidsOther, int totalRaids)
 {
     constexpr int MCP_ROOM_W = 10;
     constexpr int MCP_AVG_W = 15;
     constexpr int MCP_COUNT_W = 15;
-    constexpr int MCP_SEP_W = 0;
 
     constexpr int MCP_TOTAL_W = MCP_ROOM_W + MCP_AVG_W + MCP_COUNT_W;
 
     if (common.empty())
         return;
 
-    std::cout << "Most Common Prep Rooms:\n";
-    std::cout << std::string(MCP_TOTAL_W, '-') << "\n";
+    out.put("Most Common Prep Rooms:\n");
+    out.repeat('-', MCP_TOTAL_W).put('\n');
 
-    std::cout << std::left << std::setw(MCP_ROOM_W) << "Room"
-        << std::right << std::setw(MCP_AVG_W) << "Avg time"
-        << std::right << std::setw(MCP_COUNT_W) << "# Completed"
-        << "\n";
+    out.left("Room", MCP_ROOM_W)
+        .right("Avg time", MCP_AVG_W)
+        .right("# Completed", MCP_COUNT_W)
+        .put('\n');
 
-    std::cout << std::string(MCP_TOTAL_W, '-') << "\n";
+    out.repeat('-', MCP_TOTAL_W).put('\n');
 
     for (const auto& [room, st] : common)
     {
-        std::cout << std::left << std::setw(MCP_ROOM_W) << room
-            << std::right << std::setw(MCP_AVG_W)
-            << secondsToTime(static_cast<int>(std::round(st->avg)))
-            << std::right << std::setw(MCP_COUNT_W)
-            << st->validCount
-            << "\n";
+        out.left(room, MCP_ROOM_W)
+            .rightTime(static_cast<int>(std::round(st->avg)), MCP_AVG_W)
+            .right(st->validCount, MCP_COUNT_W)
+            .put('\n');
     }
 
-    std::cout << "\n";
+    out.put('\n');
 
     double pct5 = totalRaids > 0 ? raids5 * 100.0 / totalRaids : 0.0;
     double pct6 = totalRaids > 0 ? raids6 * 100.0 / totalRaids : 0.0;
 
-    std::cout << "Room count distribution: "
-        << "5 rooms = " << raids5
-        << " (" << std::fixed << std::setprecision(1) << pct5 << "%), "
-        << "6 rooms = " << raids6
-        << " (" << pct6 << "%)";
+    out.put("Room count distribution: ")
+        .put("5 rooms = ").put(raids5)
+        .put(" (").fixed(pct5, 1).put("%), ")
+        .put("6 rooms = ").put(raids6)
+        .put(" (").fixed(pct6, 1).put("%)");
 
     if (raidsOther > 0)
-        std::cout << ", other = " << raidsOther;
+        out.put(", other = ").put(raidsOther);
 
-    std::cout << "\n\n";
+    out.put("\n\n");
 }
 
-void printDiscardedOutliers(const std::vector<std::tuple<int, std::string, int, std::string>>& discarded, const std::string& user, const std::string& label)
+void printDiscardedOutliers(TextBuffer& out, const DiscardedOutliers& discarded, const std::string& user, const std::string& label)
 {
     if (!discarded.empty()) {
-        std::cout << "Discarded Outliers (Primary - " << user << ") - " << discarded.size() << " items:\n";
-        std::cout << std::string(80, '-') << "\n";
-        for (const auto& [kc, room, time, reason] : discarded) {
-            std::cout << "KC " << std::setw(5) << kc << " | "
-                << std::left << std::setw(26) << room
-                << std::right << std::setw(8) << secondsToTime(time)
-                << "  (" << reason << ")\n";
-        }
-        std::cout << "\n";
+        out.put("Discarded Outliers (Primary - ").put(user).put(") - ")
+            .put(static_cast<int>(discarded.size())).put(" items:\n");
+        out.repeat('-', 80).put('\n');
+        discarded.forEach([&](const OutlierRecord& d) {
+            out.put("KC ").right(d.kc, 5).put(" | ")
+                .left(d.roomName(), 26)
+                .rightTime(d.time, 8)
+                .put("  (").put(outlierReasonText(d.reason)).put(")\n");
+        });
+        out.put('\n');
     }
 }
 
-void printAnalysisSummary(const std::string& primaryUser, int totalRaids, bool hasSecondary, const std::string& secondaryUser,
-    int pastRaids, int secondaryRaidsCount) {
-    std::cout << "Analyzing " << (pastRaids == -1 ? "all" : "last " + std::to_string(pastRaids))
-        << " solo raids from " << primaryUser << " (" << totalRaids << " raids)\n";
+void printAnalysisSummary(TextBuffer& out, const std::string& primaryUser, int totalRaids, bool hasSecondary, const std::string& secondaryUser,
+    int pastRaids, int secondaryRaidsCount, int teamSize) {
+    out.put("Analyzing ");
+    if (pastRaids == -1)
+        out.put("all");
+    else
+        out.put("last ").put(pastRaids);
+    if (teamSize == 1)
+        out.put(" solo");
+    else if (teamSize == 0)
+        out.put(" any-size");
+    else
+        out.put(" team-of-").put(teamSize);
+    out.put(" raids from ").put(primaryUser).put(" (").put(totalRaids).put(" raids)\n");
     if (hasSecondary) {
-        std::cout << "Comparison vs " << secondaryUser << " (" << secondaryRaidsCount << " raids)\n";
+        out.put("Comparison vs ").put(secondaryUser).put(" (").put(secondaryRaidsCount).put(" raids)\n");
     }
-    std::cout << "\n";
+    out.put('\n');
+}
+
+void printJoinSummary(TextBuffer& out, const JoinStats& join)
+{
+    if (join.primary == 0)
+        return;
+
+    out.put("Points join: ").put(join.matched).put('/').put(join.primary).put(" raids matched")
+        .put(" (").put(join.byCompletion).put(" by completion count, ")
+        .put(join.ambiguous).put(" ambiguous), ")
+        .put(join.unmatched).put(" without points");
+    if (join.ambiguousUnmatched > 0)
+        out.put(" (").put(join.ambiguousUnmatched).put(" ambiguous)");
+    out.put(", ").put(join.unusedPoints).put(" tracker entries unused");
+
+    if (join.duplicates > 0)
+        out.put(", ").put(join.duplicates).put(" duplicates dropped");
+    if (join.rejected > 0)
+        out.put(", ").put(join.rejected).put(" left out by the query");
+
+    out.put("\n\n");
 }
 
 
-void printRoomPPHTable(const std::vector<RoomPPHResult>& rows)
+void printRoomPPHTable(TextBuffer& out, const std::vector<RoomPPHResult>& rows)
 {
     constexpr int NW = 18;
     constexpr int PW = 10;
     constexpr int CW = 8;
 
-    std::cout << "Room Efficiency (PPH)\n";
-    std::cout << std::string(38, '=') << "\n";
-    std::cout << std::left << std::setw(NW) << "Room"
-        << std::right << std::setw(PW) << "Avg PPH"
-        << std::right << std::setw(CW) << "Raids\n";
-    std::cout << std::string(38, '-') << "\n";
+    out.put("Room Efficiency (PPH)\n");
+    out.repeat('=', 38).put('\n');
+    out.left("Room", NW)
+        .right("Avg PPH", PW)
+        .right("Raids\n", CW);
+    out.repeat('-', 38).put('\n');
 
     for (const auto& r : rows)
     {
-        std::cout << std::left << std::setw(NW) << r.room
-            << std::right << std::setw(PW) << r.avgPPH
-            << std::right << std::setw(CW) << r.raids
-            << "\n";
+        out.left(r.room, NW)
+            .right(r.avgPPH, PW)
+            .right(r.raids, CW)
+            .put('\n');
     }
 
-    std::cout << std::string(38, '=') << "\n\n";
+    out.repeat('=', 38).put("\n\n");
 }
 
-Cell makeCell(int value, double avg, bool isTime, bool positiveIsGood)
+static void printLayoutSection(TextBuffer& out, const char* title, const std::vector<LayoutResult>& rows,
+    std::string (*label)(PrepMask), int maxRows)
 {
-    Cell c{};
+    constexpr int RW = 8;
+    constexpr int SW = 9;
+    constexpr int TW = 10;
+    constexpr int PW = 9;
 
-    c.value = isTime
-        ? secondsToTime(value)
-        : std::to_string(value);
-
-    int d = value - static_cast<int>(std::round(avg));
+    const size_t shown = std::min(rows.size(), static_cast<size_t>(maxRows));
+    if (shown == 0)
+        return;
 
-    if (std::abs(d) < 1)
+    std::vector<std::string> labels;
+    labels.reserve(shown);
+    int nw = 8;
+    for (size_t i = 0; i < shown; ++i)
     {
-        // Neutral zero diff: no sign, no color
-        c.diff = isTime ? secondsToTime(0) : "0";
-        c.color = COLOR_RESET;
+        labels.push_back(label(rows[i].mask));
+        nw = std::max(nw, static_cast<int>(labels.back().size()) + 2);
     }
-    else
+    const int totalW = nw + RW + SW + TW + PW;
+
+    out.put(title).put(" (top ").put(static_cast<int>(shown)).put(" of ")
+        .put(static_cast<int>(rows.size())).put(")\n");
+    out.repeat('=', totalW).put('\n');
+    out.left("Rooms", nw)
+        .right("Raids", RW)
+        .right("Share", SW)
+        .right("Avg time", TW)
+        .right("Avg PPH", PW)
+        .put('\n');
+    out.repeat('-', totalW).put('\n');
+
+    for (size_t i = 0; i < shown; ++i)
     {
-        c.diff = (d > 0 ? "+" : "-") +
-            (isTime ? secondsToTime(std::abs(d))
-                : std::to_string(std::abs(d)));
-
-        c.color = diffColor(d, isTime, positiveIsGood);
+        const auto& r = rows[i];
+        out.left(labels[i], nw)
+            .right(r.raids, RW)
+            .rightFixed(r.percent, 1, SW - 1).put('%')
+            .rightTime(r.avgSeconds, TW)
+            .right(r.avgPPH, PW)
+            .put('\n');
     }
 
+    out.repeat('=', totalW).put("\n\n");
+}
 
-    return c;
+static std::string pairLabel(PrepMask mask)
+{
+    return layoutLabel(mask, " + ");
 }
 
-bool makeSecondaryCell(const Stats& primary, const Stats& secondary, Cell& out)
+static std::string exactLabel(PrepMask mask)
 {
-    if (secondary.avg <= 0.5)
-        return false;
+    return layoutLabel(mask);
+}
 
-    int value = static_cast<int>(std::round(secondary.avg));
-    double avg = primary.avg;
+void printLayoutTables(TextBuffer& out, const LayoutAnalysis& layouts, int maxRows)
+{
+    printLayoutSection(out, "Prep Layouts", layouts.layouts, exactLabel, maxRows);
+    printLayoutSection(out, "Prep Room Pairs", layouts.pairs, pairLabel, maxRows);
+    printLayoutSection(out, "Puzzle Families", layouts.families, familyLabel, maxRows);
+}
 
-    out = makeCell(
-        value,
-        avg,
-        true,   // isTime
-        false   // lower time is better
-    );
+void printPercentileTable(TextBuffer& out, const std::vector<RoomPercentiles>& rows)
+{
+    constexpr int NW = 24;
+    constexpr int PW = 8;
+    constexpr int CW = 8;
+    constexpr int TOTAL_W = NW + 3 * PW + CW;
 
-    return true;
-}
+    if (rows.empty())
+        return;
+
+    out.put("Time Percentiles\n");
+    out.repeat('=', TOTAL_W).put('\n');
+    out.left("Room", NW)
+        .right("p10", PW)
+        .right("p50", PW)
+        .right("p90", PW)
+        .right("Raids", CW)
+        .put('\n');
+    out.repeat('-', TOTAL_W).put('\n');
+
+    bool approximate = false;
+    for (const auto& r : rows)
+    {
+        out.left(r.room, NW)
+            .rightTime(r.p10, PW)
+            .rightTime(r.p50, PW)
+            .rightTime(r.p90, PW)
+            .right(r.raids, CW)
+            .put(r.exact ? "" : " ~")
+            .put('\n');
+        approximate = approximate || !r.exact;
+    }
 
+    out.repeat('=', TOTAL_W).put('\n');
+    if (approximate)
+        out.put("~ estimated from a streaming sketch\n");
+    out.put('\n');
+}
 
-void printCell(const Cell& c)
+void printLeaderboard(TextBuffer& out, const std::vector<LeaderboardEntry>& rows, const std::string& directory, int skipped)
 {
-    std::cout
-        << std::right << std::setw(VALUE_W) << c.value
-        << " "
-        << c.color
-        << std::right << std::setw(DIFF_W) << c.diff
-        << COLOR_RESET;
+    constexpr int RK = 5;
+    constexpr int NW = 20;
+    constexpr int CW = 9;
+    constexpr int TOTAL_W = RK + NW + 6 * CW;
+
+    out.put("Leaderboard - ").put(static_cast<int>(rows.size())).put(" players from ").put(directory).put('\n');
+    out.repeat('=', TOTAL_W).put('\n');
+    out.left("#", RK)
+        .left("Player", NW)
+        .right("Raids", CW)
+        .right("Best", CW)
+        .right("Average", CW)
+        .right("Median", CW)
+        .right("Pre-Olm", CW)
+        .right("Olm", CW)
+        .put('\n');
+    out.repeat('-', TOTAL_W).put('\n');
+
+    int rank = 0;
+    for (const auto& r : rows)
+    {
+        out.left(++rank, RK)
+            .left(r.user, NW)
+            .right(r.raids, CW)
+            .rightTime(r.best, CW)
+            .rightTime(static_cast<int>(std::round(r.avg)), CW)
+            .rightTime(r.median, CW)
+            .rightTime(static_cast<int>(std::round(r.preOlm)), CW)
+            .rightTime(static_cast<int>(std::round(r.olm)), CW)
+            .put('\n');
+    }
+
+    out.repeat('=', TOTAL_W).put('\n');
+    if (skipped > 0)
+        out.put(skipped).put(" file(s) without usable raids skipped\n");
+    out.put('\n');
 }
 
-std::string centerText(const std::string& text, int width)
+void printCell(TextBuffer& out, int value, double avg, bool isTime, bool positiveIsGood)
 {
-    if (static_cast<int>(text.size()) >= width)
-        return text.substr(0, width);
+    char valueBuf[16];
+    out.right(std::string_view(valueBuf, formatValue(valueBuf, value, isTime)), VALUE_W).put(' ');
 
-    int pad = width - static_cast<int>(text.size());
-    int left = pad / 2;
-    int right = pad - left;
+    int d = value - static_cast<int>(std::round(avg));
 
-    return std::string(left, ' ') + text + std::string(right, ' ');
-}
\ No newline at end of file
+    char diffBuf[17];
+    size_t diffLen = 0;
+    const char* color = COLOR_RESET;
+
+    if (std::abs(d) < 1)
+    {
+        // Neutral zero diff: no sign, no color
+        diffLen = formatValue(diffBuf, 0, isTime);
+    }
+    else
+    {
+        diffBuf[0] = (d > 0) ? '+' : '-';
+        diffLen = 1 + formatValue(diffBuf + 1, std::abs(d), isTime);
+        color = diffColor(d, isTime, positiveIsGood);
+    }
+
+    out.put(color)
+        .right(std::string_view(diffBuf, diffLen), DIFF_W)
+        .put(COLOR_RESET);
+}
@@ -6,6 +6,8 @@
 
 #include "Types.h"
 #include "PointsLoader.h"
+#include "TextBuffer.h"
+#include "LayoutStats.h"
 
 // Width of numeric value printed in value/diff columns (e.g. "77455")
 constexpr int VALUE_W = 6;
@@ -26,13 +28,6 @@ const int CW = 18;  // Comparison column (vs secondary user)
 const int SEP = 5;  // Spaces between columns
 
 
-struct Cell
-{
-    std::string value;   // "17:23" or "77455"
-    std::string diff;    // "+0:12" or "-36322"
-    const char* color;   // COLOR_GREEN / COLOR_RED / COLOR_RESET
-};
-
 inline const char* diffColor(
     int diff,
     bool isTime,
@@ -64,29 +59,37 @@ inline const char* diffColor(
 }
 
 
-void printRaidStatisticsHeader(const std::string& primaryUser, const std::string& secondaryUser, bool hasSecondary, int totalWidth, int nPastRaids);
+// All printers append to out; the caller writes it once with out.flush()
 
-void printStatsTable(const std::map<std::string, Stats>& primaryStats, const std::map<std::string, Stats>& secondaryStats, const std::map<std::string,
+void printRaidStatisticsHeader(TextBuffer& out, const std::string& primaryUser, const std::string& secondaryUser, bool hasSecondary, int totalWidth, const std::vector<int>& lastNs);
+
+void printStatsTable(TextBuffer& out, const std::map<std::string, Stats>& primaryStats, const std::map<std::string, Stats>& secondaryStats, const std::map<std::string,
     int>& recentVal, const std::string& secondaryUser, int totalWidth, bool hasSecondary, PointsToPrint PPH, PointsToPrint Points,
-    std::map<std::string, double> lastNAvg);
+    const std::vector<std::map<std::string, double>>& lastNAvgs);
 
-void printMostCommonPrepRooms(const std::vector<std::pair<std::string, const Stats*>>& common,
+void printMostCommonPrepRooms(TextBuffer& out, const std::vector<std::pair<std::string, const Stats*>>& common,
     int raids5, int raids6, int raidsOther,
     int totalRaids);
 
-void printDiscardedOutliers(const std::vector<std::tuple<int, std::string, int, std::string>>& discarded,
+void printDiscardedOutliers(TextBuffer& out, const DiscardedOutliers& discarded,
     const std::string& user,
     const std::string& label);
 
-void printAnalysisSummary(const std::string& primaryUser, int totalRaids, bool hasSecondary, const std::string& secondaryUser, 
-    int pastRaids, int secondaryRaidsCount);
+// teamSize as in RaidQuery: 1 = solo, 0 = any size
+void printAnalysisSummary(TextBuffer& out, const std::string& primaryUser, int totalRaids, bool hasSecondary, const std::string& secondaryUser, 
+    int pastRaids, int secondaryRaidsCount, int teamSize = 1);
+
+void printJoinSummary(TextBuffer& out, const JoinStats& join);
 
-void printRoomPPHTable(const std::vector<RoomPPHResult>& rows);
+void printRoomPPHTable(TextBuffer& out, const std::vector<RoomPPHResult>& rows);
 
-Cell makeCell(int value, double avg, bool isTime, bool positiveIsGood);
+void printPercentileTable(TextBuffer& out, const std::vector<RoomPercentiles>& rows);
 
-bool makeSecondaryCell(const Stats& primary, const Stats& secondary, Cell& out);
+// Exact layouts, room pairs and puzzle families, maxRows of each
+void printLayoutTables(TextBuffer& out, const LayoutAnalysis& layouts, int maxRows);
 
-void printCell(const Cell& c);
+// Players sorted by average completion time, fastest first
+void printLeaderboard(TextBuffer& out, const std::vector<LeaderboardEntry>& rows, const std::string& directory, int skipped);
 
-std::string centerText(const std::string& text, int width);
+// <value> <color><signed diff from avg><reset>, VALUE_W + 1 + DIFF_W visible characters
+void printCell(TextBuffer& out, int value, double avg, bool isTime, bool positiveIsGood);
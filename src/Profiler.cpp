@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "Profiler.h"
+
+struct ProfileEvent
+{
+    const char* name;
+    int64_t startUs;
+    int64_t durationUs;
+    uint64_t allocs;
+    uint64_t allocBytes;
+    int thread;
+};
+
+struct ProfileCounter
+{
+    const char* name;
+    int64_t value;
+};
+
+static std::atomic<bool> enabled{ false };
+static std::atomic<uint64_t> allocCount{ 0 };
+static std::atomic<uint64_t> allocBytes{ 0 };
+
+static std::mutex profileMutex;                 // Guards everything below
+static std::vector<ProfileEvent> events;
+static std::vector<ProfileCounter> counters;    // Few names, looked up linearly
+static std::string tracePathSetting;
+static std::chrono::steady_clock::time_point origin;
+
+static int64_t nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - origin).count();
+}
+
+// Small stable id per thread for the trace's tid field
+static int threadId()
+{
+    static std::atomic<int> next{ 1 };
+    thread_local int id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+template <typename T>
+static std::string_view formatInt(char (&buf)[32], T value)
+{
+    auto r = std::to_chars(buf, buf + sizeof(buf), value);
+    return std::string_view(buf, static_cast<size_t>(r.ptr - buf));
+}
+
+static std::string_view formatFixed(char (&buf)[32], double value, int precision)
+{
+    auto r = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+    return std::string_view(buf, static_cast<size_t>(r.ptr - buf));
+}
+
+static uint64_t peakRssBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return static_cast<uint64_t>(pmc.PeakWorkingSetSize);
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss);          // bytes
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;   // kilobytes
+#endif
+#endif
+}
+
+void enableProfiling(const std::string& tracePath)
+{
+    std::lock_guard<std::mutex> lock(profileMutex);
+    origin = std::chrono::steady_clock::now();
+    tracePathSetting = tracePath;
+    events.reserve(256);
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+bool profilingEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void profileCount(const char* name, int64_t n)
+{
+    if (!profilingEnabled())
+        return;
+
+    std::lock_guard<std::mutex> lock(profileMutex);
+    for (auto& c : counters)
+    {
+        if (c.name == name || std::string_view(c.name) == name)
+        {
+            c.value += n;
+            return;
+        }
+    }
+    counters.push_back({ name, n });
+}
+
+ProfileScope::ProfileScope(const char* name)
+    : name(name), active(profilingEnabled())
+{
+    if (!active)
+        return;
+    startAllocs = allocCount.load(std::memory_order_relaxed);
+    startBytes = allocBytes.load(std::memory_order_relaxed);
+    startUs = nowUs();
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (!active)
+        return;
+
+    ProfileEvent e{ name, startUs, nowUs() - startUs,
+        allocCount.load(std::memory_order_relaxed) - startAllocs,
+        allocBytes.load(std::memory_order_relaxed) - startBytes,
+        threadId() };
+
+    std::lock_guard<std::mutex> lock(profileMutex);
+    events.push_back(e);
+}
+
+void printProfileSummary(TextBuffer& out)
+{
+    constexpr int NAME_W = 20;
+    constexpr int COL_W = 11;
+    constexpr int TOTAL_W = NAME_W + 5 * COL_W;
+
+    struct PhaseTotal
+    {
+        const char* name;
+        int calls;
+        int64_t us;
+        uint64_t allocs;
+        uint64_t bytes;
+    };
+
+    std::lock_guard<std::mutex> lock(profileMutex);
+    const int64_t wallUs = std::max<int64_t>(nowUs(), 1);
+
+    // Phases in the order they first finished
+    std::vector<PhaseTotal> phases;
+    for (const auto& e : events)
+    {
+        auto it = std::find_if(phases.begin(), phases.end(),
+            [&](const PhaseTotal& p) { return std::string_view(p.name) == e.name; });
+        if (it == phases.end())
+            it = phases.insert(phases.end(), { e.name, 0, 0, 0, 0 });
+        it->calls++;
+        it->us += e.durationUs;
+        it->allocs += e.allocs;
+        it->bytes += e.allocBytes;
+    }
+
+    out.put("Profile\n");
+    out.repeat('=', TOTAL_W).put('\n');
+    out.left("Phase", NAME_W)
+        .right("Calls", COL_W)
+        .right("Time ms", COL_W)
+        .right("% wall", COL_W)
+        .right("Allocs", COL_W)
+        .right("Alloc KB", COL_W)
+        .put('\n');
+    out.repeat('-', TOTAL_W).put('\n');
+
+    char buf[32];
+    for (const auto& p : phases)
+    {
+        out.left(p.name, NAME_W)
+            .right(p.calls, COL_W)
+            .right(formatFixed(buf, p.us / 1000.0, 2), COL_W)
+            .right(formatFixed(buf, p.us * 100.0 / wallUs, 1), COL_W)
+            .right(formatInt(buf, p.allocs), COL_W)
+            .right(formatFixed(buf, p.bytes / 1024.0, 1), COL_W)
+            .put('\n');
+    }
+
+    out.repeat('-', TOTAL_W).put('\n');
+    out.left("Wall", NAME_W).repeat(' ', COL_W)
+        .right(formatFixed(buf, wallUs / 1000.0, 2), COL_W).put('\n');
+
+    if (!counters.empty())
+    {
+        out.put('\n');
+        out.left("Counter", NAME_W).right("Value", 2 * COL_W).right("Per second", 2 * COL_W).put('\n');
+        for (const auto& c : counters)
+        {
+            out.left(c.name, NAME_W)
+                .right(formatInt(buf, c.value), 2 * COL_W)
+                .right(formatFixed(buf, c.value * 1e6 / wallUs, 0), 2 * COL_W)
+                .put('\n');
+        }
+    }
+
+    out.put("\nPeak RSS: ").fixed(peakRssBytes() / (1024.0 * 1024.0), 1).put(" MB\n");
+    out.repeat('=', TOTAL_W).put("\n\n");
+}
+
+bool writeProfileTrace(const std::string& path)
+{
+    TextBuffer out;
+    {
+        std::lock_guard<std::mutex> lock(profileMutex);
+        const int64_t endUs = nowUs();
+        char buf[32];
+
+        out.put("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        for (const auto& e : events)
+        {
+            out.put(first ? "" : ",\n");
+            first = false;
+            out.put("{\"name\":\"").put(e.name)
+                .put("\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":").put(e.thread)
+                .put(",\"ts\":").put(formatInt(buf, e.startUs))
+                .put(",\"dur\":").put(formatInt(buf, e.durationUs))
+                .put(",\"args\":{\"allocs\":").put(formatInt(buf, e.allocs))
+                .put(",\"alloc_bytes\":").put(formatInt(buf, e.allocBytes))
+                .put("}}");
+        }
+        for (const auto& c : counters)
+        {
+            out.put(first ? "" : ",\n");
+            first = false;
+            out.put("{\"name\":\"").put(c.name)
+                .put("\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":").put(formatInt(buf, endUs))
+                .put(",\"args\":{\"value\":").put(formatInt(buf, c.value))
+                .put("}}");
+        }
+        out.put("\n]}\n");
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(out.data.data(), static_cast<std::streamsize>(out.data.size()));
+    return static_cast<bool>(file);
+}
+
+void finishProfiling()
+{
+    if (!profilingEnabled())
+        return;
+
+    TextBuffer out;
+    printProfileSummary(out);
+    out.flush();
+
+    if (!tracePathSetting.empty())
+    {
+        if (writeProfileTrace(tracePathSetting))
+            std::cout << "Profile trace written to " << tracePathSetting << "\n";
+        else
+            std::cerr << "Cannot write " << tracePathSetting << "\n";
+    }
+}
+
+
+// ===================== ALLOCATION COUNTING =====================
+// Replaces the global operator new/delete; the library's array and
+// nothrow forms call these, over-aligned allocations are not counted
+
+void* operator new(std::size_t size)
+{
+    if (enabled.load(std::memory_order_relaxed))
+    {
+        allocCount.fetch_add(1, std::memory_order_relaxed);
+        allocBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    if (size == 0)
+        size = 1;
+    for (;;)
+    {
+        if (void* p = std::malloc(size))
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "TextBuffer.h"
+
+// Phase timers, counters and allocation counts for --profile
+// Everything is off until enableProfiling(); a disabled scope or counter
+// costs one relaxed atomic load
+
+// tracePath empty: summary only; otherwise a Chrome trace is written there too
+void enableProfiling(const std::string& tracePath = "");
+bool profilingEnabled();
+
+// Adds n to a named counter; name must outlive the run (a string literal)
+void profileCount(const char* name, int64_t n);
+
+// Times the enclosing block as one phase. Allocations made on any thread
+// while it is open are charged to it, so nested phases count inclusively
+struct ProfileScope
+{
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    bool active;
+    int64_t startUs = 0;
+    uint64_t startAllocs = 0;
+    uint64_t startBytes = 0;
+};
+
+// Per-phase totals, counters with rates over the profiled wall time, peak RSS
+void printProfileSummary(TextBuffer& out);
+
+// Every recorded scope as a complete ("X") event plus the final counter
+// values, loadable in chrome://tracing or Perfetto; false if the write fails
+bool writeProfileTrace(const std::string& path);
+
+// Prints the summary and writes the trace if one was requested
+void finishProfiling();
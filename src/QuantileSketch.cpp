@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "QuantileSketch.h"
+
+// Rank (1-based) of the q-quantile among n weighted samples
+static int64_t nearestRank(double q, int64_t n)
+{
+    q = std::clamp(q, 0.0, 1.0);
+    return std::max<int64_t>(1, static_cast<int64_t>(std::ceil(q * static_cast<double>(n))));
+}
+
+void QuantileSketch::push(int32_t value)
+{
+    if (levels.empty())
+        levels.emplace_back();
+
+    levels[0].push_back(value);
+    ++count;
+
+    const size_t limit = exact() ? EXACT_LIMIT : capacity(0);
+    if (levels[0].size() > limit)
+        compress();
+}
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+    if (other.levels.size() > levels.size())
+        levels.resize(other.levels.size());
+
+    for (size_t h = 0; h < other.levels.size(); ++h)
+        levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+
+    count += other.count;
+    compress();
+}
+
+// Top level holds K items, each level below two thirds of the one above
+size_t QuantileSketch::capacity(size_t level) const
+{
+    const size_t depth = levels.size() - 1 - level;
+    const double cap = static_cast<double>(K) * std::pow(2.0 / 3.0, static_cast<double>(depth));
+    return std::max(MIN_CAPACITY, static_cast<size_t>(std::ceil(cap)));
+}
+
+// Sorts each full level and promotes every other item one level up,
+// doubling its weight; an odd item out stays behind so weights add up
+void QuantileSketch::compress()
+{
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t h = 0; h < levels.size(); ++h)
+        {
+            const size_t limit = exact() ? EXACT_LIMIT : capacity(h);
+            if (levels[h].size() <= limit)
+                continue;
+
+            if (h + 1 == levels.size())
+                levels.emplace_back();
+
+            auto& level = levels[h];
+            std::sort(level.begin(), level.end());
+
+            int32_t held = 0;
+            const bool odd = (level.size() % 2) != 0;
+            if (odd)
+            {
+                held = level.back();
+                level.pop_back();
+            }
+
+            const size_t offset = coin & 1u;
+            coin ^= 1u;
+            for (size_t i = offset; i < level.size(); i += 2)
+                levels[h + 1].push_back(level[i]);
+
+            level.clear();
+            if (odd)
+                level.push_back(held);
+            changed = true;
+        }
+    }
+}
+
+int32_t QuantileSketch::quantile(double q) const
+{
+    if (count == 0)
+        return 0;
+
+    if (exact())
+    {
+        std::vector<int32_t> v = levels[0];
+        const auto k = static_cast<size_t>(nearestRank(q, static_cast<int64_t>(v.size())) - 1);
+        std::nth_element(v.begin(), v.begin() + k, v.end());
+        return v[k];
+    }
+
+    std::vector<std::pair<int32_t, int64_t>> weighted;
+    int64_t total = 0;
+    for (size_t h = 0; h < levels.size(); ++h)
+    {
+        const int64_t w = int64_t{ 1 } << h;
+        for (int32_t v : levels[h])
+            weighted.emplace_back(v, w);
+        total += w * static_cast<int64_t>(levels[h].size());
+    }
+    std::sort(weighted.begin(), weighted.end());
+
+    const int64_t rank = nearestRank(q, total);
+    int64_t seen = 0;
+    for (const auto& [v, w] : weighted)
+    {
+        seen += w;
+        if (seen >= rank)
+            return v;
+    }
+    return weighted.back().first;
+}
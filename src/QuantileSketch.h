@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Mergeable streaming quantile sketch (KLL compactor stack)
+// Small samples are kept whole and answered exactly; past EXACT_LIMIT the
+// levels are compacted so memory stays bounded however many raids come in.
+// An item on level h stands for 2^h samples.
+struct QuantileSketch
+{
+    static constexpr size_t K = 200;             // Capacity of the top level
+    static constexpr size_t MIN_CAPACITY = 8;    // Floor for the lower levels
+    static constexpr size_t EXACT_LIMIT = 1024;  // Samples kept before compacting at all
+
+    std::vector<std::vector<int32_t>> levels;
+    int64_t count = 0;
+    uint32_t coin = 0;          // Alternates which half survives a compaction
+
+    void push(int32_t value);
+
+    // Adds everything other has seen, e.g. another file's or thread's sketch
+    void merge(const QuantileSketch& other);
+
+    // Nearest-rank quantile, q in [0, 1]; 0 when empty
+    int32_t quantile(double q) const;
+
+    bool exact() const { return levels.size() <= 1; }
+
+private:
+    size_t capacity(size_t level) const;
+    void compress();
+};
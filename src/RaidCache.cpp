@@ -0,0 +1,297 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+#include "RaidCache.h"
+#include "InputFunctions.h"
+#include "MappedFile.h"
+
+constexpr char CACHE_MAGIC[8] = { 'C', 'O', 'X', 'C', 'A', 'C', 'H', 'E' };
+constexpr uint32_t CACHE_VERSION = 3;       // Bump when the file layout changes
+constexpr size_t PREFIX_HASH_BYTES = 4096;  // Bytes before the resume offset that must not change
+
+enum class CacheKind : uint32_t
+{
+    CoxTimes = 1,
+    Points = 2
+};
+
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint32_t recordSize;     // sizeof the record type, catches struct changes
+    uint32_t roomCount;      // ROOM_COUNT when written
+    uint64_t parsedBytes;
+    uint64_t prefixHash;
+    uint64_t count;          // Raids or points entries
+    uint64_t keyCount;       // Join keys (CoxTimes only)
+};
+
+static uint64_t fnv1a(const char* p, size_t n)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < n; ++i)
+    {
+        h ^= static_cast<unsigned char>(p[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static uint64_t prefixHash(std::string_view text, uint64_t offset)
+{
+    const size_t end = static_cast<size_t>(offset);
+    const size_t n = std::min(end, PREFIX_HASH_BYTES);
+    return fnv1a(text.data() + end - n, n);
+}
+
+// True when the already-parsed prefix is still byte-identical in text
+static bool prefixStillValid(std::string_view text, uint64_t parsedBytes, uint64_t hash)
+{
+    if (parsedBytes == 0)
+        return true;
+    return parsedBytes <= text.size() && prefixHash(text, parsedBytes) == hash;
+}
+
+static CacheHeader makeHeader(CacheKind kind, uint32_t recordSize)
+{
+    CacheHeader h{};
+    std::memcpy(h.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    h.version = CACHE_VERSION;
+    h.kind = static_cast<uint32_t>(kind);
+    h.recordSize = recordSize;
+    h.roomCount = static_cast<uint32_t>(ROOM_COUNT);
+    return h;
+}
+
+// Maps the cache and checks it was written by this build for this kind of input
+static bool openCache(const std::string& cachePath, const CacheHeader& expected, MappedFile& file, CacheHeader& h)
+{
+    if (!file.open(cachePath) || file.size < sizeof(CacheHeader))
+        return false;
+
+    std::memcpy(&h, file.data, sizeof(CacheHeader));
+    return std::memcmp(h.magic, expected.magic, sizeof(h.magic)) == 0
+        && h.version == expected.version
+        && h.kind == expected.kind
+        && h.recordSize == expected.recordSize
+        && h.roomCount == expected.roomCount;
+}
+
+template <typename T>
+static bool readArray(const MappedFile& file, size_t& offset, uint64_t count, std::vector<T>& out)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "cached records are copied as raw bytes");
+
+    if (count > (file.size - offset) / sizeof(T))
+        return false;
+
+    out.resize(static_cast<size_t>(count));
+    if (count > 0)
+        std::memcpy(out.data(), file.data + offset, out.size() * sizeof(T));
+    offset += out.size() * sizeof(T);
+    return true;
+}
+
+template <typename T>
+static void writeArray(std::ofstream& out, const std::vector<T>& v)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "cached records are copied as raw bytes");
+    out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+// Writes to a temporary file first so a crash never leaves a torn cache
+// A failed write only costs a re-parse next time
+template <typename A, typename B>
+static void writeCache(const std::string& cachePath, const CacheHeader& h, const std::vector<A>& first, const std::vector<B>& second)
+{
+    const std::string tmpPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return;
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        writeArray(out, first);
+        writeArray(out, second);
+        if (!out)
+            return;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    if (ec)
+        std::filesystem::remove(tmpPath, ec);
+}
+
+static bool loadState(const std::string& cachePath, RaidFileState& state)
+{
+    MappedFile file;
+    CacheHeader h;
+    if (!openCache(cachePath, makeHeader(CacheKind::CoxTimes, sizeof(Raid)), file, h))
+        return false;
+
+    size_t offset = sizeof(CacheHeader);
+    if (!readArray(file, offset, h.count, state.raids) || !readArray(file, offset, h.keyCount, state.joinKeys))
+    {
+        state = RaidFileState{};
+        return false;
+    }
+    state.parsedBytes = h.parsedBytes;
+    state.prefixHash = h.prefixHash;
+    return true;
+}
+
+static void saveState(const std::string& cachePath, const RaidFileState& state)
+{
+    CacheHeader h = makeHeader(CacheKind::CoxTimes, sizeof(Raid));
+    h.parsedBytes = state.parsedBytes;
+    h.prefixHash = state.prefixHash;
+    h.count = state.raids.size();
+    h.keyCount = state.joinKeys.size();
+    writeCache(cachePath, h, state.raids, state.joinKeys);
+}
+
+static bool loadState(const std::string& cachePath, PointsFileState& state)
+{
+    MappedFile file;
+    CacheHeader h;
+    if (!openCache(cachePath, makeHeader(CacheKind::Points, sizeof(PointsRaid)), file, h))
+        return false;
+
+    size_t offset = sizeof(CacheHeader);
+    if (!readArray(file, offset, h.count, state.points))
+    {
+        state = PointsFileState{};
+        return false;
+    }
+    state.parsedBytes = h.parsedBytes;
+    state.prefixHash = h.prefixHash;
+    return true;
+}
+
+static void saveState(const std::string& cachePath, const PointsFileState& state)
+{
+    CacheHeader h = makeHeader(CacheKind::Points, sizeof(PointsRaid));
+    h.parsedBytes = state.parsedBytes;
+    h.prefixHash = state.prefixHash;
+    h.count = state.points.size();
+    writeCache(cachePath, h, state.points, std::vector<char>{});
+}
+
+std::string cachePathFor(const std::string& sourcePath)
+{
+    return sourcePath + ".coxcache";
+}
+
+int updateRaidFile(const std::string& path, RaidFileState& state, std::vector<PrimaryRaid>* pendingKeys,
+    std::vector<Raid>* pendingRaids)
+{
+    MappedFile src;
+    if (!src.open(path))
+        return -1;
+
+    const std::string_view text = src.view();
+    state.restarted = !prefixStillValid(text, state.parsedBytes, state.prefixHash);
+    if (state.restarted)
+    {
+        state.raids.clear();
+        state.joinKeys.clear();
+        state.parsedBytes = 0;
+    }
+
+    const size_t raidsBefore = state.raids.size();
+    const size_t keysBefore = state.joinKeys.size();
+
+    ParseResume r = parseRaidsText(text.substr(static_cast<size_t>(state.parsedBytes)), state.raids, &state.joinKeys);
+
+    // Keep only what lies before the resume point; the rest is re-parsed next time
+    const size_t committedKeys = keysBefore + r.keys;
+    const size_t committedRaids = raidsBefore + r.records;
+    if (pendingKeys)
+        pendingKeys->assign(state.joinKeys.begin() + committedKeys, state.joinKeys.end());
+    if (pendingRaids)
+        pendingRaids->assign(state.raids.begin() + committedRaids, state.raids.end());
+    state.joinKeys.resize(committedKeys);
+    state.raids.resize(committedRaids);
+
+    state.parsedBytes += r.offset;
+    state.prefixHash = prefixHash(text, state.parsedBytes);
+    return static_cast<int>(r.records);
+}
+
+int updatePointsFile(const std::string& path, PointsFileState& state, std::vector<PointsRaid>* pending)
+{
+    MappedFile src;
+    if (!src.open(path))
+        return -1;
+
+    const std::string_view text = src.view();
+    state.restarted = !prefixStillValid(text, state.parsedBytes, state.prefixHash);
+    if (state.restarted)
+    {
+        state.points.clear();
+        state.parsedBytes = 0;
+    }
+
+    const size_t before = state.points.size();
+    ParseResume r = parsePointsText(text.substr(static_cast<size_t>(state.parsedBytes)), state.points);
+
+    const size_t committed = before + r.records;
+    if (pending)
+        pending->assign(state.points.begin() + committed, state.points.end());
+    state.points.resize(committed);
+
+    state.parsedBytes += r.offset;
+    state.prefixHash = prefixHash(text, state.parsedBytes);
+    return static_cast<int>(r.records);
+}
+
+// mode only matters for the fallback; incremental updates always use the mapped scanner
+bool readRaidsCached(const std::string& filename, std::vector<Raid>& raids, ParserMode mode,
+    std::vector<PrimaryRaid>* joinKeys)
+{
+    const std::string cachePath = cachePathFor(filename);
+
+    RaidFileState state;
+    const bool cached = loadState(cachePath, state);
+    const uint64_t before = state.parsedBytes;
+
+    std::vector<PrimaryRaid> pending;
+    std::vector<Raid> pendingRaids;
+    if (updateRaidFile(filename, state, &pending, &pendingRaids) < 0)
+        return readRaids(filename, raids, mode, joinKeys);   // reports the open error
+
+    if (!cached || state.restarted || state.parsedBytes != before)
+        saveState(cachePath, state);
+
+    if (joinKeys)
+    {
+        *joinKeys = std::move(state.joinKeys);
+        joinKeys->insert(joinKeys->end(), pending.begin(), pending.end());
+    }
+    raids = std::move(state.raids);
+    raids.insert(raids.end(), pendingRaids.begin(), pendingRaids.end());
+    return !raids.empty();
+}
+
+std::vector<PointsRaid> loadPointsFileCached(const std::string& path)
+{
+    const std::string cachePath = cachePathFor(path);
+
+    PointsFileState state;
+    const bool cached = loadState(cachePath, state);
+    const uint64_t before = state.parsedBytes;
+
+    std::vector<PointsRaid> pending;
+    if (updatePointsFile(path, state, &pending) < 0)
+        return {};
+
+    if (!cached || state.restarted || state.parsedBytes != before)
+        saveState(cachePath, state);
+
+    state.points.insert(state.points.end(), pending.begin(), pending.end());
+    return std::move(state.points);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Types.h"
+#include "PointsLoader.h"
+
+// Both RuneLite plugins only ever append to their files. A file state keeps
+// everything parsed up to the last complete record plus the offset of that
+// record boundary, so the next update only parses the bytes after it.
+// The state is persisted next to the source as "<file>.coxcache".
+
+// Parsed prefix of a CoxTimes export
+struct RaidFileState
+{
+    std::vector<Raid> raids;
+    std::vector<PrimaryRaid> joinKeys;
+    uint64_t parsedBytes = 0;   // Just past the last complete "-----" line
+    uint64_t prefixHash = 0;    // Hash of the bytes right before parsedBytes
+    bool restarted = false;     // Last update had to parse from the start
+};
+
+// Parsed prefix of a raid-tracker log
+struct PointsFileState
+{
+    std::vector<PointsRaid> points;
+    uint64_t parsedBytes = 0;   // Just past the last complete JSON line
+    uint64_t prefixHash = 0;
+    bool restarted = false;
+};
+
+// Parses only what was appended after state.parsedBytes, or the whole file
+// when the bytes before that offset changed. Records that are not complete
+// yet go to the optional pending outputs and are parsed again next time.
+// Returns the number of records added to the state, -1 if unreadable
+int updateRaidFile(const std::string& path, RaidFileState& state, std::vector<PrimaryRaid>* pendingKeys = nullptr,
+    std::vector<Raid>* pendingRaids = nullptr);
+
+int updatePointsFile(const std::string& path, PointsFileState& state, std::vector<PointsRaid>* pending = nullptr);
+
+// Same contract as readRaids, going through the persisted state
+// mode is only used when the file cannot be mapped; updates always use the mapped scanner
+bool readRaidsCached(const std::string& filename, std::vector<Raid>& raids, ParserMode mode,
+    std::vector<PrimaryRaid>* joinKeys = nullptr);
+
+// Same result as loadPointsFile, going through the persisted state
+std::vector<PointsRaid> loadPointsFileCached(const std::string& path);
+
+std::string cachePathFor(const std::string& sourcePath);
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <limits>
+
+#include "RaidQuery.h"
+
+constexpr int64_t MS_PER_DAY = 86400000;
+
+bool RaidQuery::acceptsRaid(const Raid& raid) const
+{
+    if (raid.kc < minKC || raid.kc > maxKC)
+        return false;
+    if ((raid.present & required) != required || (raid.present & excluded) != 0)
+        return false;
+
+    const PrepMask prep = raid.prepMask();
+    if (layout && prep != *layout)
+        return false;
+    const int prepCount = std::popcount(prep);
+    if (prepCount < minPrep || prepCount > maxPrep)
+        return false;
+
+    // Absent rooms hold 0, so an open range lets raids without a time through
+    const int seconds = raid.get(Room::RaidCompleted);
+    return seconds >= minSeconds && seconds <= maxSeconds;
+}
+
+bool RaidQuery::acceptsPoints(const PointsRaid& points) const
+{
+    if ((mode == RaidMode::Normal && points.challengeMode) || (mode == RaidMode::Challenge && !points.challengeMode))
+        return false;
+    if (points.totalPoints < minPoints || points.totalPoints > maxPoints)
+        return false;
+
+    // An entry without a date only passes when dates are not asked for
+    if (minDate == INT64_MIN && maxDate == INT64_MAX)
+        return true;
+    return points.date >= 0 && points.date >= minDate && points.date <= maxDate;
+}
+
+// One "<field><op><value>" clause
+struct QueryClause {
+    std::string_view field;
+    std::string_view op;
+    std::string_view value;
+};
+
+static bool splitClause(std::string_view token, QueryClause& c)
+{
+    const size_t p = token.find_first_of("<>=");
+    if (p == std::string_view::npos || p == 0)
+        return false;
+
+    size_t q = p + 1;
+    if (token[p] != '=' && q < token.size() && token[q] == '=')
+        ++q;
+
+    c.field = token.substr(0, p);
+    c.op = token.substr(p, q - p);
+    c.value = token.substr(q);
+    return !c.value.empty();
+}
+
+template <typename T>
+static bool parseNumber(std::string_view s, T& out)
+{
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc() && ptr == s.data() + s.size();
+}
+
+// "m:ss" or plain seconds
+static bool parseSeconds(std::string_view s, int& out)
+{
+    const size_t colon = s.find(':');
+    if (colon == std::string_view::npos)
+        return parseNumber(s, out);
+
+    int m = 0, sec = 0;
+    if (!parseNumber(s.substr(0, colon), m) || !parseNumber(s.substr(colon + 1), sec)
+        || sec < 0 || sec >= 60 || m < 0 || m > (std::numeric_limits<int>::max() - sec) / 60)
+        return false;
+    out = m * 60 + sec;
+    return true;
+}
+
+// "YYYY-MM-DD" -> epoch milliseconds at 00:00 UTC
+static bool parseDate(std::string_view s, int64_t& out)
+{
+    int y = 0, m = 0, d = 0;
+    if (s.size() != 10 || s[4] != '-' || s[7] != '-'
+        || !parseNumber(s.substr(0, 4), y) || !parseNumber(s.substr(5, 2), m) || !parseNumber(s.substr(8, 2), d))
+        return false;
+
+    const std::chrono::year_month_day ymd{ std::chrono::year(y), std::chrono::month(m), std::chrono::day(d) };
+    if (!ymd.ok())
+        return false;
+    out = std::chrono::sys_days(ymd).time_since_epoch().count() * MS_PER_DAY;
+    return true;
+}
+
+// Narrows [lo, hi] by "op value", where the value covers first..last
+// (a whole day for dates, a single number otherwise)
+// "< min" and "> max" match nothing, so they leave lo > hi rather than wrap
+template <typename T>
+static void applyBound(std::string_view op, T first, T last, T& lo, T& hi)
+{
+    constexpr T MIN = std::numeric_limits<T>::min();
+    constexpr T MAX = std::numeric_limits<T>::max();
+
+    if (op == "=") {
+        lo = std::max(lo, first);
+        hi = std::min(hi, last);
+    }
+    else if (op == "<") {
+        if (first == MIN) {
+            lo = MAX;
+            hi = MIN;
+        }
+        else
+            hi = std::min(hi, first - 1);
+    }
+    else if (op == "<=")
+        hi = std::min(hi, last);
+    else if (op == ">") {
+        if (last == MAX) {
+            lo = MAX;
+            hi = MIN;
+        }
+        else
+            lo = std::max(lo, last + 1);
+    }
+    else
+        lo = std::max(lo, first);
+}
+
+// Case-insensitive room name, '_' for space
+static Room findRoom(std::string_view name)
+{
+    for (size_t i = 0; i < ROOM_COUNT; ++i)
+    {
+        const std::string_view candidate = ROOM_NAMES[i];
+        if (candidate.size() != name.size())
+            continue;
+
+        bool same = true;
+        for (size_t k = 0; k < name.size() && same; ++k)
+        {
+            const char c = (name[k] == '_') ? ' ' : name[k];
+            same = std::tolower(static_cast<unsigned char>(c)) == std::tolower(static_cast<unsigned char>(candidate[k]));
+        }
+        if (same)
+            return static_cast<Room>(i);
+    }
+    return Room::Count;
+}
+
+// Comma-separated room names -> presence bits
+static bool parseRooms(std::string_view list, uint32_t& out, std::string& error)
+{
+    out = 0;
+    while (!list.empty())
+    {
+        const size_t comma = list.find(',');
+        const std::string_view name = list.substr(0, comma);
+        list = (comma == std::string_view::npos) ? std::string_view() : list.substr(comma + 1);
+
+        const Room room = findRoom(name);
+        if (room == Room::Count || room == Room::TotalPoints || room == Room::PPH) {
+            error = "unknown room '" + std::string(name) + "'";
+            return false;
+        }
+        // Filled in by finalizeDerivedRaidTimes, after the parser has decided
+        if (room == Room::PreOlm || room == Room::BetweenRoom) {
+            error = "'" + std::string(ROOM_NAMES[roomIndex(room)]) + "' is derived after parsing and cannot be filtered on";
+            return false;
+        }
+        out |= roomBit(room);
+    }
+    return true;
+}
+
+static bool applyClause(const QueryClause& c, RaidQuery& q, std::string& error)
+{
+    const bool equals = c.op == "=";
+    const std::string clause = std::string(c.field) + std::string(c.op) + std::string(c.value);
+
+    auto bad = [&] {
+        error = "bad value in '" + clause + "'";
+        return false;
+    };
+    auto equalsOnly = [&] {
+        error = "'" + std::string(c.field) + "' only takes =";
+        return false;
+    };
+
+    if (c.field == "kc" || c.field == "points" || c.field == "prep" || c.field == "time")
+    {
+        int v = 0;
+        if (!(c.field == "time" ? parseSeconds(c.value, v) : parseNumber(c.value, v)))
+            return bad();
+
+        if (c.field == "kc")
+            applyBound(c.op, v, v, q.minKC, q.maxKC);
+        else if (c.field == "points")
+            applyBound(c.op, v, v, q.minPoints, q.maxPoints);
+        else if (c.field == "prep")
+            applyBound(c.op, v, v, q.minPrep, q.maxPrep);
+        else
+            applyBound(c.op, v, v, q.minSeconds, q.maxSeconds);
+        return true;
+    }
+
+    if (c.field == "date")
+    {
+        int64_t day = 0;
+        if (!parseDate(c.value, day))
+            return bad();
+        applyBound(c.op, day, day + MS_PER_DAY - 1, q.minDate, q.maxDate);
+        return true;
+    }
+
+    if (!equals && (c.field == "team" || c.field == "mode" || c.field == "has" || c.field == "without"
+        || c.field == "layout" || c.field == "last"))
+        return equalsOnly();
+
+    if (c.field == "team")
+    {
+        if (c.value == "any")
+            q.teamSize = 0;
+        else if (!parseNumber(c.value, q.teamSize) || q.teamSize < 1)
+            return bad();
+        return true;
+    }
+
+    if (c.field == "mode")
+    {
+        if (c.value == "normal")
+            q.mode = RaidMode::Normal;
+        else if (c.value == "cm")
+            q.mode = RaidMode::Challenge;
+        else if (c.value == "any")
+            q.mode = RaidMode::Any;
+        else
+            return bad();
+        return true;
+    }
+
+    if (c.field == "has" || c.field == "without" || c.field == "layout")
+    {
+        uint32_t rooms = 0;
+        if (!parseRooms(c.value, rooms, error))
+            return false;
+
+        if (c.field == "has")
+            q.required |= rooms;
+        else if (c.field == "without")
+            q.excluded |= rooms;
+        else if ((rooms & ~PREP_ROOM_MASK) != 0) {
+            error = "layout only takes prep rooms";
+            return false;
+        }
+        else
+            q.layout = prepMask(rooms);
+        return true;
+    }
+
+    if (c.field == "last")
+    {
+        if (!parseNumber(c.value, q.last) || q.last < 1)
+            return bad();
+        return true;
+    }
+
+    error = "unknown field '" + std::string(c.field) + "'";
+    return false;
+}
+
+bool parseRaidQuery(std::string_view text, RaidQuery& out, std::string& error)
+{
+    RaidQuery q;
+    size_t pos = 0;
+
+    while (pos < text.size())
+    {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+            ++pos;
+        size_t end = pos;
+        while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end])))
+            ++end;
+        if (end == pos)
+            break;
+
+        const std::string_view token = text.substr(pos, end - pos);
+        pos = end;
+
+        QueryClause c;
+        if (!splitClause(token, c)) {
+            error = "expected <field><op><value>, got '" + std::string(token) + "'";
+            return false;
+        }
+        if (!applyClause(c, q, error))
+            return false;
+
+        if (!q.text.empty())
+            q.text += ' ';
+        q.text += token;
+    }
+
+    out = std::move(q);
+    return true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "Types.h"
+#include "PointsLoader.h"
+
+enum class RaidMode {
+    Normal,
+    Challenge,
+    Any
+};
+
+// Conditions a raid must meet to be analyzed; bounds are inclusive
+// The default query is what the tool always kept: solo, normal mode
+//
+// Where each check runs:
+//   CoxTimes parser      team, kc, time, has/without, layout, prep
+//                        (rejected raids are never stored)
+//   tracker-log parser   team
+//   matchPoints          mode, date, points, on the entry a raid matched
+// CoxTimes has no date, mode or points, so those only apply to the player
+// whose raids go through the points join (see needsPoints)
+struct RaidQuery {
+    std::string text;                   // As given, for the report header
+
+    int teamSize = 1;                   // 0 = any
+    RaidMode mode = RaidMode::Normal;
+    int minKC = INT_MIN, maxKC = INT_MAX;
+    int minSeconds = INT_MIN, maxSeconds = INT_MAX;     // Raid Completed
+    int minPoints = INT_MIN, maxPoints = INT_MAX;
+    int minPrep = 0, maxPrep = INT_MAX;                 // Number of prep rooms
+    int64_t minDate = INT64_MIN, maxDate = INT64_MAX;   // Epoch milliseconds
+    uint32_t required = 0;              // Room bits that must be present
+    uint32_t excluded = 0;              // Room bits that must be absent
+    std::optional<PrepMask> layout;     // Exact prep-room set
+    int last = -1;                      // Keep only the newest N raids left, -1 = all
+
+    bool active() const { return !text.empty(); }
+
+    // True when the parsers' defaults hold, so cached solo raids can be filtered
+    // instead of parsing again
+    bool cacheCompatible() const { return teamSize == 1; }
+
+    // Mode, date or points clauses, which only the points join can check
+    bool needsPoints() const
+    {
+        return mode != RaidMode::Normal || minPoints != INT_MIN || maxPoints != INT_MAX
+            || minDate != INT64_MIN || maxDate != INT64_MAX;
+    }
+
+    bool acceptsTeamSize(int size) const { return teamSize == 0 || size == teamSize; }
+
+    // CoxTimes record, once its "---" line closes it
+    bool acceptsRaid(const Raid& raid) const;
+
+    // The tracker entry a raid was matched to (mode, date, points)
+    bool acceptsPoints(const PointsRaid& points) const;
+};
+
+inline const RaidQuery DEFAULT_RAID_QUERY{};
+
+// Whitespace-separated clauses, all of which must hold, e.g.
+//   "kc>=1000 date>=2024-01-01 has=Tekton,Ice_demon time<18:00 last=200"
+// Fields: kc, time (m:ss or seconds), points, prep, date (YYYY-MM-DD, UTC),
+// team (number or any), mode (normal, cm, any), has, without, layout (room lists;
+// '_' stands for a space; derived rows like Pre-Olm are refused), last
+// Ops: = < <= > >= (has, without, layout, team, mode and last take only =)
+// False with a message in error when the text does not parse
+bool parseRaidQuery(std::string_view text, RaidQuery& out, std::string& error);
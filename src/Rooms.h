@@ -0,0 +1,204 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// ======================== ROOM REGISTRY ========================
+// Every row a raid can hold, in display order. Adding a room is one line here.
+// X(id, label in the CoxTimes export, kind, min seconds, max seconds, raid-tracker JSON key)
+//   Prep rooms come first, so their presence bits are the low bits
+//   Displayed rows follow; Hidden rows are only parsed (for the points join)
+//   min/max are the fixed outlier limits; 0 means no limit
+#define COX_ROOMS(X) \
+    X(Tekton,       "Tekton",                Prep,      30, 240, "tektonTime") \
+    X(Crabs,        "Crabs",                 Prep,      45, 240, "crabsTime") \
+    X(IceDemon,     "Ice demon",             Prep,      90, 240, "iceDemonTime") \
+    X(Shamans,      "Shamans",               Prep,      27, 240, "shamansTime") \
+    X(Vanguards,    "Vanguards",             Prep,      60, 240, "vanguardsTime") \
+    X(Thieving,     "Thieving",              Prep,      45, 240, "thievingTime") \
+    X(Vespula,      "Vespula",               Prep,      15, 240, "vespulaTime") \
+    X(Tightrope,    "Tightrope",             Prep,      25, 240, "tightropeTime") \
+    X(Guardians,    "Guardians",             Prep,      35, 240, "guardiansTime") \
+    X(Vasa,         "Vasa",                  Prep,      30, 240, "vasaTime") \
+    X(Mystics,      "Mystics",               Prep,      30, 240, "mysticsTime") \
+    X(Muttadiles,   "Muttadiles",            Prep,      45, 240, "muttadilesTime") \
+    X(PreOlm,       "Pre-Olm",               Displayed,  0,   0, "") \
+    X(OlmMageHand1, "Olm mage hand phase 1", Displayed,  0,   0, "") \
+    X(OlmPhase1,    "Olm phase 1",           Displayed,  0,   0, "") \
+    X(OlmMageHand2, "Olm mage hand phase 2", Displayed,  0,   0, "") \
+    X(OlmPhase2,    "Olm phase 2",           Displayed,  0,   0, "") \
+    X(OlmPhase3,    "Olm phase 3",           Displayed,  0,   0, "") \
+    X(OlmHead,      "Olm head",              Displayed,  0,   0, "") \
+    X(Olm,          "Olm",                   Displayed,  0,   0, "") \
+    X(RaidCompleted,"Raid Completed",        Displayed,  0,   0, "raidTime") \
+    X(BetweenRoom,  "Between room time",     Displayed, 20, 600, "") \
+    X(TotalPoints,  "Total Points",          Displayed,  0,   0, "totalPoints") \
+    X(PPH,          "PPH",                   Displayed,  0,   0, "") \
+    X(Floor1,       "Floor 1",               Hidden,     0,   0, "upperTime") \
+    X(Floor2,       "Floor 2",               Hidden,     0,   0, "")
+
+enum class RoomKind : uint8_t {
+    Prep,
+    Displayed,
+    Hidden
+};
+
+enum class Room : uint8_t {
+#define COX_ROOM_ID(id, name, kind, minSeconds, maxSeconds, trackerKey) id,
+    COX_ROOMS(COX_ROOM_ID)
+#undef COX_ROOM_ID
+    Count
+};
+
+struct RoomInfo {
+    std::string_view name;
+    RoomKind kind;
+    int minSeconds;
+    int maxSeconds;
+    std::string_view trackerKey;    // Empty when the tracker has no such field
+};
+
+constexpr size_t ROOM_COUNT = static_cast<size_t>(Room::Count);
+
+constexpr std::array<RoomInfo, ROOM_COUNT> ROOM_INFO = { {
+#define COX_ROOM_INFO(id, name, kind, minSeconds, maxSeconds, trackerKey) \
+    { name, RoomKind::kind, minSeconds, maxSeconds, trackerKey },
+    COX_ROOMS(COX_ROOM_INFO)
+#undef COX_ROOM_INFO
+} };
+
+constexpr std::array<std::string_view, ROOM_COUNT> ROOM_NAMES = [] {
+    std::array<std::string_view, ROOM_COUNT> names{};
+    for (size_t i = 0; i < ROOM_COUNT; ++i)
+        names[i] = ROOM_INFO[i].name;
+    return names;
+}();
+
+constexpr size_t countRooms(RoomKind kind)
+{
+    size_t n = 0;
+    for (const auto& r : ROOM_INFO)
+        n += r.kind == kind;
+    return n;
+}
+
+// Kinds must be contiguous in Prep, Displayed, Hidden order
+constexpr bool roomKindsOrdered()
+{
+    for (size_t i = 1; i < ROOM_COUNT; ++i)
+        if (ROOM_INFO[i].kind < ROOM_INFO[i - 1].kind)
+            return false;
+    return true;
+}
+static_assert(roomKindsOrdered(), "COX_ROOMS must list prep rooms, then displayed rows, then hidden ones");
+
+constexpr size_t PREP_ROOM_COUNT = countRooms(RoomKind::Prep);
+constexpr uint32_t PREP_ROOM_MASK = (1u << PREP_ROOM_COUNT) - 1;
+constexpr size_t DISPLAY_ROOM_COUNT = PREP_ROOM_COUNT + countRooms(RoomKind::Displayed);   // Rows of DISPLAY_ORDER
+constexpr uint32_t DISPLAY_ROOM_MASK = (1u << DISPLAY_ROOM_COUNT) - 1;
+static_assert(ROOM_COUNT <= 32, "presence bits are a uint32_t");
+
+constexpr size_t roomIndex(Room room)
+{
+    return static_cast<size_t>(room);
+}
+
+constexpr uint32_t roomBit(Room room)
+{
+    return 1u << roomIndex(room);
+}
+
+constexpr bool isPrepRoom(Room room)
+{
+    return roomIndex(room) < PREP_ROOM_COUNT;
+}
+
+constexpr const RoomInfo& roomInfo(Room room)
+{
+    return ROOM_INFO[roomIndex(room)];
+}
+
+// Prep-room layout of a raid: bit i set when prep room i was in it
+// Prep rooms hold the low bits of Raid::present, so this is a plain mask
+using PrepMask = uint16_t;
+static_assert(PREP_ROOM_COUNT <= 16, "prep layouts are a uint16_t");
+
+constexpr PrepMask prepMask(uint32_t present)
+{
+    return static_cast<PrepMask>(present & PREP_ROOM_MASK);
+}
+
+// Puzzle rooms; a layout's puzzle subset is its rotation family
+constexpr PrepMask PUZZLE_ROOM_MASK = static_cast<PrepMask>(
+    roomBit(Room::Crabs) | roomBit(Room::IceDemon) | roomBit(Room::Thieving) | roomBit(Room::Tightrope));
+
+// Position of each room's name in alphabetical (byte) order, so lists
+// sorted by name can compare two bytes instead of two strings
+constexpr std::array<uint8_t, ROOM_COUNT> ROOM_NAME_RANK = [] {
+    std::array<uint8_t, ROOM_COUNT> rank{};
+    for (size_t i = 0; i < ROOM_COUNT; ++i)
+        for (size_t j = 0; j < ROOM_COUNT; ++j)
+            rank[i] += ROOM_NAMES[j] < ROOM_NAMES[i];
+    return rank;
+}();
+
+
+// ==================== NAME -> ROOM (PERFECT HASH) ==================
+// Hashes only the length and the first, middle and last characters; a
+// seed is searched at compile time so that no two labels share a slot.
+// A lookup is one multiply, one table load and one compare of the label
+
+constexpr unsigned ROOM_HASH_BITS = 6;
+constexpr size_t ROOM_HASH_SIZE = size_t{ 1 } << ROOM_HASH_BITS;
+
+constexpr uint32_t roomNameHash(std::string_view s, uint32_t seed)
+{
+    if (s.empty())
+        return 0;
+    const uint32_t first = static_cast<unsigned char>(s.front());
+    const uint32_t middle = static_cast<unsigned char>(s[s.size() / 2]);
+    const uint32_t last = static_cast<unsigned char>(s.back());
+    const uint32_t key = static_cast<uint32_t>(s.size()) | first << 8 | middle << 16 | last << 24;
+    return (key * seed) >> (32 - ROOM_HASH_BITS);
+}
+
+constexpr uint32_t findRoomHashSeed()
+{
+    for (uint32_t seed = 0x9E3779B1u; seed < 0x9E3779B1u + 2 * 65536; seed += 2)
+    {
+        std::array<bool, ROOM_HASH_SIZE> used{};
+        bool unique = true;
+        for (const auto& r : ROOM_INFO)
+        {
+            const uint32_t h = roomNameHash(r.name, seed);
+            unique = unique && !used[h];
+            used[h] = true;
+        }
+        if (unique)
+            return seed;
+    }
+    return 0;
+}
+
+constexpr uint32_t ROOM_HASH_SEED = findRoomHashSeed();
+static_assert(ROOM_HASH_SEED != 0, "no collision-free seed; widen ROOM_HASH_BITS or the hashed characters");
+
+constexpr std::array<Room, ROOM_HASH_SIZE> ROOM_HASH_TABLE = [] {
+    std::array<Room, ROOM_HASH_SIZE> table{};
+    table.fill(Room::Count);
+    for (size_t i = 0; i < ROOM_COUNT; ++i)
+        table[roomNameHash(ROOM_INFO[i].name, ROOM_HASH_SEED)] = static_cast<Room>(i);
+    return table;
+}();
+
+// Room::Count for labels that are not tracked
+constexpr Room roomFromName(std::string_view name)
+{
+    const Room room = ROOM_HASH_TABLE[roomNameHash(name, ROOM_HASH_SEED)];
+    return (room != Room::Count && ROOM_NAMES[roomIndex(room)] == name) ? room : Room::Count;
+}
+
+static_assert(roomFromName("Ice demon") == Room::IceDemon);
+static_assert(roomFromName("Olm") == Room::Olm);
+static_assert(roomFromName("Olm phase 4") == Room::Count);
@@ -1,8 +1,91 @@
 ﻿#include <iostream>
+#include <string>
+#include <cstdlib>
 #include "CoxParser.h"
-int main() {
+#include "Profiler.h"
+#include "SyntheticData.h"
+#include "Benchmark.h"
+int main(int argc, char* argv[]) {
 
-    runCoxAnalytics();
+    // --profile prints a phase summary after the run, --profile=<file> also writes a Chrome trace
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--profile")
+            enableProfiling();
+        else if (arg.starts_with("--profile="))
+            enableProfiling(arg.substr(10));
+    }
+
+    // --query "<clauses>" narrows the default run, --compare and --export
+    RaidQuery query;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg != "--query")
+            continue;
+        std::string error;
+        if (i + 1 >= argc || !parseRaidQuery(argv[i + 1], query, error)) {
+            std::cerr << "--query: " << (error.empty() ? "needs a query" : error) << "\n";
+            return 1;
+        }
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--watch") {
+            if (query.active()) {
+                std::cerr << "--query does not apply to --watch\n";
+                return 1;
+            }
+            runWatchMode();
+            return 0;
+        }
+        if (arg == "--compare") {
+            if (i + 1 >= argc) {
+                std::cerr << "--compare needs a directory\n";
+                return 1;
+            }
+            if (query.needsPoints()) {
+                std::cerr << "--query: mode, date and points need the tracker log, which --compare does not read\n";
+                return 1;
+            }
+            const bool ok = runCompareMode(argv[i + 1], query);
+            finishProfiling();
+            return ok ? 0 : 1;
+        }
+        if (arg == "--export") {
+            if (i + 1 >= argc) {
+                std::cerr << "--export needs a directory\n";
+                return 1;
+            }
+            const bool ok = runExportMode(argv[i + 1], query);
+            finishProfiling();
+            return ok ? 0 : 1;
+        }
+        if (arg == "--generate") {
+            // --generate <dir> [raids]
+            const long long raids = (i + 2 < argc) ? std::atoll(argv[i + 2]) : 10000;
+            if (i + 1 >= argc || raids < SYNTHETIC_MIN_RAIDS || raids > SYNTHETIC_MAX_RAIDS) {
+                std::cerr << "--generate needs a directory and " << SYNTHETIC_MIN_RAIDS
+                    << " to " << SYNTHETIC_MAX_RAIDS << " raids\n";
+                return 1;
+            }
+            return generateSyntheticLogs(argv[i + 1], raids) ? 0 : 1;
+        }
+        if (arg == "--bench") {
+            // --bench <dir> [--save-baseline]; fails when a stage regressed
+            if (i + 1 >= argc) {
+                std::cerr << "--bench needs a directory\n";
+                return 1;
+            }
+            bool save = false;
+            for (int j = 1; j < argc; ++j)
+                save = save || std::string(argv[j]) == "--save-baseline";
+            return runBenchmarks(argv[i + 1], save) == 0 ? 0 : 1;
+        }
+    }
+
+    runCoxAnalytics(query);
+    finishProfiling();
     std::getchar();
 
     return 0;
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "SyntheticData.h"
+#include "TextBuffer.h"
+
+constexpr size_t WRITE_CHUNK_BYTES = 1 << 20;   // Buffer flushed to disk past this size
+constexpr int KC_OFFSET = 34;                   // Tracker completionCount minus CoxTimes KC
+constexpr int64_t START_DATE_MS = 1700000000000;
+constexpr int64_t LEARNING_CURVE_PERCENT = 35;  // First raid this much slower than the last
+
+// Per mille of raids getting each kind of noise
+constexpr int TEAM_RAID_PERMILLE = 30;          // CoxTimes raid with Team Size > 1
+constexpr int MISSING_POINTS_PERMILLE = 50;     // Solo raid the tracker did not log
+constexpr int CM_ENTRY_PERMILLE = 40;           // Extra tracker entry for a CM
+constexpr int TEAM_ENTRY_PERMILLE = 40;         // Extra tracker entry for a team raid
+constexpr int STRAY_ENTRY_PERMILLE = 20;        // Solo tracker entry with no CoxTimes raid
+constexpr int FULL_LAYOUT_PERMILLE = 320;       // Six prep rooms instead of five
+
+// splitmix64; std distributions differ between standard libraries
+struct SyntheticRng
+{
+    uint64_t state;
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [lo, hi]
+    int range(int lo, int hi)
+    {
+        return lo + static_cast<int>(next() % static_cast<uint64_t>(hi - lo + 1));
+    }
+
+    bool chance(int permille)
+    {
+        return range(0, 999) < permille;
+    }
+
+    // Roughly normal (Irwin-Hall of four uniforms), never below a third of mean
+    int around(int mean, int spread)
+    {
+        const int sum = range(-spread, spread) + range(-spread, spread)
+            + range(-spread, spread) + range(-spread, spread);
+        return std::max(mean / 3, mean + sum / 2);
+    }
+};
+
+struct SyntheticRoom
+{
+    const char* name;
+    int mean;       // Seconds
+    int spread;
+    bool puzzle;
+};
+
+// Means close to the example exports
+constexpr std::array<SyntheticRoom, 12> SYNTHETIC_ROOMS = { {
+    { "Tekton", 75, 20, false },
+    { "Crabs", 80, 20, true },
+    { "Ice demon", 155, 18, true },
+    { "Shamans", 70, 18, false },
+    { "Vanguards", 115, 25, false },
+    { "Thieving", 130, 25, true },
+    { "Vespula", 60, 15, false },
+    { "Tightrope", 70, 15, true },
+    { "Guardians", 85, 20, false },
+    { "Vasa", 100, 20, false },
+    { "Mystics", 100, 22, false },
+    { "Muttadiles", 150, 30, false },
+} };
+
+struct SyntheticRaid
+{
+    int kc;
+    int team;
+    int floor1;
+    int floor2;
+    int olm;
+    int completed;
+    int prepRooms;
+};
+
+// "m:ss" like the CoxTimes plugin
+static TextBuffer& putMinSec(TextBuffer& out, int seconds)
+{
+    out.put(seconds / 60).put(':');
+    return out.put(static_cast<char>('0' + seconds % 60 / 10)).put(static_cast<char>('0' + seconds % 10));
+}
+
+static void putRoomLine(TextBuffer& out, const char* name, int seconds)
+{
+    putMinSec(out.put(name).put(": "), seconds).put('\n');
+}
+
+// Picks a layout and writes one raid block; returns the times the tracker sees
+// pace is a percentage of the mean room times (players get faster over an archive)
+static SyntheticRaid writeCoxTimesRaid(TextBuffer& out, SyntheticRng& rng, int kc, int pace)
+{
+    SyntheticRaid r{};
+    r.kc = kc;
+    r.team = rng.chance(TEAM_RAID_PERMILLE) ? rng.range(2, 5) : 1;
+    r.prepRooms = rng.chance(FULL_LAYOUT_PERMILLE) ? 6 : 5;
+
+    // One puzzle per floor, the rest combat rooms, no room twice
+    uint32_t used = 0;
+    auto pick = [&](bool puzzle) {
+        for (;;)
+        {
+            const int i = rng.range(0, static_cast<int>(SYNTHETIC_ROOMS.size()) - 1);
+            if (SYNTHETIC_ROOMS[i].puzzle == puzzle && !(used & (1u << i)))
+            {
+                used |= 1u << i;
+                return i;
+            }
+        }
+    };
+
+    const int floor1Rooms = 3;
+    const int floor2Rooms = r.prepRooms - floor1Rooms;
+    for (int floor = 0; floor < 2; ++floor)
+    {
+        const int rooms = floor == 0 ? floor1Rooms : floor2Rooms;
+        int total = rng.around(70 * pace / 100, 20);     // Walking between rooms
+        for (int k = 0; k < rooms; ++k)
+        {
+            const SyntheticRoom& room = SYNTHETIC_ROOMS[pick(k == 0)];
+            const int t = rng.around(room.mean * pace / 100, room.spread);
+            putRoomLine(out, room.name, t);
+            total += t;
+        }
+        (floor == 0 ? r.floor1 : r.floor2) = total;
+        putRoomLine(out, floor == 0 ? "Floor 1" : "Floor 2", total);
+    }
+
+    static constexpr std::array<std::pair<const char*, int>, 6> OLM_PHASES = { {
+        { "Olm mage hand phase 1", 55 },
+        { "Olm phase 1", 120 },
+        { "Olm mage hand phase 2", 55 },
+        { "Olm phase 2", 115 },
+        { "Olm phase 3", 110 },
+        { "Olm head", 125 },
+    } };
+    for (const auto& [name, mean] : OLM_PHASES)
+    {
+        const int t = rng.around(mean * pace / 100, 12);
+        putRoomLine(out, name, t);
+        r.olm += t;
+    }
+    putRoomLine(out, "Olm", r.olm);
+
+    r.completed = r.floor1 + r.floor2 + r.olm + rng.range(5, 40);
+    putMinSec(out.put("Raid Completed: "), r.completed).put(" | Team Size: ").put(r.team).put('\n');
+    out.put("CoX KC: ").put(kc).put('\n');
+    out.repeat('-', 96).put('\n').repeat('-', 96).put('\n');
+    return r;
+}
+
+// One raid-tracker JSON line with the keys the plugin writes
+static void writeTrackerLine(TextBuffer& out, bool cm, int team, int upper, int raidTime,
+    int points, int completionCount, int64_t dateMs)
+{
+    char date[24];
+    auto d = std::to_chars(date, date + sizeof(date), dateMs);
+
+    out.put("{\"accountHash\":-1,\"profileType\":\"\",\"chestOpened\":true,\"raidComplete\":true,\"loggedIn\":true,\"challengeMode\":")
+        .put(cm ? "true" : "false")
+        .put(",\"inRaidChambers\":true,\"inTheatreOfBlood\":false,\"inTombsOfAmascut\":false,\"FreeForAll\":false,\"upperTime\":").put(upper)
+        .put(",\"middleTime\":-1,\"lowerTime\":").put(raidTime - upper)
+        .put(",\"raidTime\":").put(raidTime)
+        .put(",\"raidLevel\":-1,\"totalPoints\":").put(points)
+        .put(",\"personalPoints\":").put(points / team)
+        .put(",\"personalDeathCount\":0,\"totalTeamDeathCount\":0,\"teamSize\":").put(team)
+        .put(",\"percentage\":100.0,\"completionCount\":").put(completionCount)
+        .put(",\"specialLoot\":\"\",\"specialLootReceiver\":\"\",\"specialLootInOwnName\":false,\"specialLootValue\":-1,"
+            "\"lootList\":[{\"name\":\"Dragon arrow\",\"id\":11212,\"quantity\":175,\"price\":140000}],"
+            "\"maidenTime\":-1,\"bloatTime\":-1,\"nyloTime\":-1,\"sotetsegTime\":-1,\"xarpusTime\":-1,\"verzikTime\":-1,"
+            "\"tobCompTime\":-1,\"mvp\":\"\",\"mvpInOwnName\":false,\"toaCompTime\":-1,\"date\":")
+        .put(std::string_view(date, static_cast<size_t>(d.ptr - date)))
+        .put("}\n");
+}
+
+static bool flushTo(std::ofstream& file, TextBuffer& buf)
+{
+    file.write(buf.data.data(), static_cast<std::streamsize>(buf.data.size()));
+    buf.data.clear();
+    return static_cast<bool>(file);
+}
+
+bool generateSyntheticLogs(const std::string& directory, int64_t raids, uint64_t seed)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+
+    const std::filesystem::path dir(directory);
+    const std::filesystem::path coxPath = dir / "Synthetic_CoxTimes.txt";
+    const std::filesystem::path trackerPath = dir / "raid_tracker_data.log";
+
+    std::ofstream cox(coxPath, std::ios::binary | std::ios::trunc);
+    std::ofstream tracker(trackerPath, std::ios::binary | std::ios::trunc);
+    if (!cox || !tracker)
+    {
+        std::cerr << "Cannot create the synthetic logs in " << directory << "\n";
+        return false;
+    }
+
+    SyntheticRng rng{ seed };
+    TextBuffer coxBuf, trackerBuf;
+    int64_t date = START_DATE_MS;
+    int trackerCount = KC_OFFSET;
+
+    for (int64_t i = 0; i < raids; ++i)
+    {
+        const int kc = static_cast<int>(i) + 1;
+        const int pace = 100 + static_cast<int>(LEARNING_CURVE_PERCENT * (raids - i) / raids);
+        const SyntheticRaid r = writeCoxTimesRaid(coxBuf, rng, kc, pace);
+        date += static_cast<int64_t>(r.completed + rng.range(60, 600)) * 1000;
+
+        // Other raids the tracker logs in between
+        if (rng.chance(CM_ENTRY_PERMILLE))
+            writeTrackerLine(trackerBuf, true, 1, rng.around(1100, 150), rng.around(2700, 300),
+                rng.around(70000, 8000), ++trackerCount, date - 1000);
+        if (rng.chance(TEAM_ENTRY_PERMILLE))
+            writeTrackerLine(trackerBuf, false, rng.range(2, 5), rng.around(600, 100), rng.around(1500, 200),
+                rng.around(90000, 15000), ++trackerCount, date - 500);
+        if (rng.chance(STRAY_ENTRY_PERMILLE))
+            writeTrackerLine(trackerBuf, false, 1, rng.around(500, 80), rng.around(1300, 150),
+                rng.around(32000, 3000), ++trackerCount, date - 250);
+
+        if (r.team == 1)
+        {
+            ++trackerCount;
+            if (!rng.chance(MISSING_POINTS_PERMILLE))
+            {
+                // The two plugins round a second apart now and then
+                const int upper = r.floor1 + rng.range(-1, 1);
+                const int points = rng.around(26000 + 2500 * r.prepRooms, 1500);
+                writeTrackerLine(trackerBuf, false, 1, upper, r.completed, points, trackerCount, date);
+            }
+        }
+
+        if (coxBuf.data.size() > WRITE_CHUNK_BYTES && !flushTo(cox, coxBuf))
+            break;
+        if (trackerBuf.data.size() > WRITE_CHUNK_BYTES && !flushTo(tracker, trackerBuf))
+            break;
+    }
+
+    const bool ok = flushTo(cox, coxBuf) && flushTo(tracker, trackerBuf);
+    if (!ok)
+        std::cerr << "Write failed while generating " << directory << "\n";
+    else
+        std::cout << "Wrote " << raids << " raids to " << coxPath.string() << " and " << trackerPath.string() << "\n";
+    return ok;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Raid counts --generate accepts
+constexpr int64_t SYNTHETIC_MIN_RAIDS = 1000;
+constexpr int64_t SYNTHETIC_MAX_RAIDS = 10'000'000;
+
+// Writes <dir>/Synthetic_CoxTimes.txt and <dir>/raid_tracker_data.log in the
+// plugins' formats, streamed so any size fits in memory. The same seed gives
+// the same bytes on every platform.
+// Noise the real logs have is mixed in: team raids in the CoxTimes file,
+// CM and team entries in the tracker, raids missing from the tracker and
+// tracker entries with no CoxTimes raid. Returns false on a write error
+bool generateSyntheticLogs(const std::string& directory, int64_t raids, uint64_t seed = 1);
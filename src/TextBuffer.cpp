@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <charconv>
+
+#include "TextBuffer.h"
+
+size_t formatTime(char* buf, int seconds)
+{
+    if (seconds <= 0)
+        seconds = 0;
+
+    const int m = seconds / 60;
+    const int s = seconds % 60;
+
+    char* p = buf;
+    if (m < 10)
+        *p++ = '0';
+    p = std::to_chars(p, buf + 12, m).ptr;
+    *p++ = ':';
+    *p++ = static_cast<char>('0' + s / 10);
+    *p++ = static_cast<char>('0' + s % 10);
+    return static_cast<size_t>(p - buf);
+}
+
+TextBuffer& TextBuffer::put(int value)
+{
+    char buf[16];
+    auto r = std::to_chars(buf, buf + sizeof(buf), value);
+    data.append(buf, r.ptr);
+    return *this;
+}
+
+TextBuffer& TextBuffer::repeat(char c, int count)
+{
+    if (count > 0)
+        data.append(static_cast<size_t>(count), c);
+    return *this;
+}
+
+TextBuffer& TextBuffer::left(std::string_view s, int width)
+{
+    data.append(s);
+    return repeat(' ', width - static_cast<int>(s.size()));
+}
+
+TextBuffer& TextBuffer::left(int value, int width)
+{
+    char buf[16];
+    auto r = std::to_chars(buf, buf + sizeof(buf), value);
+    return left(std::string_view(buf, static_cast<size_t>(r.ptr - buf)), width);
+}
+
+TextBuffer& TextBuffer::right(std::string_view s, int width)
+{
+    repeat(' ', width - static_cast<int>(s.size()));
+    data.append(s);
+    return *this;
+}
+
+TextBuffer& TextBuffer::right(int value, int width)
+{
+    char buf[16];
+    auto r = std::to_chars(buf, buf + sizeof(buf), value);
+    return right(std::string_view(buf, static_cast<size_t>(r.ptr - buf)), width);
+}
+
+TextBuffer& TextBuffer::center(std::string_view s, int width)
+{
+    if (static_cast<int>(s.size()) >= width)
+        return put(s.substr(0, static_cast<size_t>(std::max(width, 0))));
+
+    const int pad = width - static_cast<int>(s.size());
+    const int leftPad = pad / 2;
+    repeat(' ', leftPad);
+    data.append(s);
+    return repeat(' ', pad - leftPad);
+}
+
+TextBuffer& TextBuffer::time(int seconds)
+{
+    char buf[16];
+    data.append(buf, formatTime(buf, seconds));
+    return *this;
+}
+
+TextBuffer& TextBuffer::rightTime(int seconds, int width)
+{
+    char buf[16];
+    return right(std::string_view(buf, formatTime(buf, seconds)), width);
+}
+
+TextBuffer& TextBuffer::fixed(double value, int precision)
+{
+    char buf[64];
+    auto r = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+    data.append(buf, r.ptr);
+    return *this;
+}
+
+TextBuffer& TextBuffer::rightFixed(double value, int precision, int width)
+{
+    char buf[64];
+    auto r = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+    return right(std::string_view(buf, static_cast<size_t>(r.ptr - buf)), width);
+}
+
+void TextBuffer::flush(std::FILE* out)
+{
+    if (!data.empty())
+        std::fwrite(data.data(), 1, data.size(), out);
+    std::fflush(out);
+    data.clear();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// Report text formatted into one growing buffer and written out at once
+// Width helpers follow std::setw: pad up to the width, never truncate
+struct TextBuffer
+{
+    static constexpr size_t INITIAL_CAPACITY = 64 * 1024;
+
+    std::string data;
+
+    TextBuffer() { data.reserve(INITIAL_CAPACITY); }
+
+    TextBuffer& put(std::string_view s) { data.append(s); return *this; }
+    TextBuffer& put(char c) { data.push_back(c); return *this; }
+    TextBuffer& put(int value);
+    TextBuffer& repeat(char c, int count);
+
+    TextBuffer& left(std::string_view s, int width);
+    TextBuffer& left(int value, int width);
+    TextBuffer& right(std::string_view s, int width);
+    TextBuffer& right(int value, int width);
+
+    // Centred in exactly width characters; longer text is cut
+    TextBuffer& center(std::string_view s, int width);
+
+    // Seconds as "mm:ss" ("00:00" for <= 0), like secondsToTime
+    TextBuffer& time(int seconds);
+    TextBuffer& rightTime(int seconds, int width);
+
+    // Same digits as std::fixed << std::setprecision(precision)
+    TextBuffer& fixed(double value, int precision);
+    TextBuffer& rightFixed(double value, int precision, int width);
+
+    // One fwrite of everything so far, then the buffer is emptied
+    void flush(std::FILE* out = stdout);
+};
+
+// Writes "mm:ss" into buf (at least 16 chars) and returns the length
+size_t formatTime(char* buf, int seconds);
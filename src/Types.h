@@ -1,8 +1,16 @@
 ﻿#pragma once
 
 #include <string>
+#include <string_view>
 #include <map>
 #include <vector>
+#include <array>
+#include <tuple>
+#include <algorithm>
+#include <cstdint>
+
+#include "QuantileSketch.h"
+#include "Rooms.h"
 
 #define COLOR_GREEN "\033[32m"
 #define COLOR_RED   "\033[31m"
@@ -16,89 +24,273 @@ enum class LayoutFilter {
     FullOnly      // all prep rooms
 };
 
+enum class OutlierMode {
+    Fixed,        // min/max seconds from COX_ROOMS
+    Adaptive      // Rolling median and MAD per room and player
+};
+
+enum class ParserMode {
+    Stream,       // std::getline over an ifstream
+    Mapped        // whole file mapped, scanned with string_view
+};
+
 // Represents a single Chambers of Xeric raid run
-// Times are stored per room in seconds
+// Times are stored per room in seconds, indexed by Room
 // Derived values (totalSeconds, Pre-Olm) are filled later
 // Points are attached later from a separate source
 struct Raid {
-    int kc;                              // Kill count at time of raid
-    std::map<std::string, int> times;    // Room name, seconds
-    int totalSeconds = 0;                // Total raid duration (derived)
-    int totalPoints = -1;                // Points earned in this raid
+    int kc = 0;                                  // Kill count at time of raid
+    std::array<int32_t, ROOM_COUNT> times{};     // Seconds per room, valid where present
+    uint32_t present = 0;                        // Bit per Room that has a time
+    int totalSeconds = 0;                        // Total raid duration (derived)
+    int totalPoints = -1;                        // Points earned in this raid
+
+    bool has(Room room) const { return (present & roomBit(room)) != 0; }
+    int get(Room room) const { return times[roomIndex(room)]; }
+    PrepMask prepMask() const { return ::prepMask(present); }
+    void set(Room room, int seconds)
+    {
+        times[roomIndex(room)] = seconds;
+        present |= roomBit(room);
+    }
+};
+
+// Where parsing of an append-only input can pick up again: the offset just
+// past the last complete record, and how many records/join keys were
+// produced before it (counts are relative to that parse call)
+struct ParseResume {
+    size_t offset = 0;
+    size_t records = 0;
+    size_t keys = 0;
 };
 
+// Column store of a raid list, used by the aggregation passes
+// Row i of every column belongs to the same raid; absent rooms hold 0
+struct RaidTable {
+    std::vector<int32_t> kc;
+    std::vector<int32_t> totalSeconds;
+    std::vector<int32_t> totalPoints;
+    std::vector<uint32_t> layout;                          // Raid::present bits
+    std::array<std::vector<int32_t>, ROOM_COUNT> times;    // One column per Room
+
+    size_t size() const { return kc.size(); }
+    bool empty() const { return kc.empty(); }
+    const std::vector<int32_t>& column(Room room) const { return times[roomIndex(room)]; }
+};
+
+
+// Welford running statistics for one room's valid samples
+// push() is O(1) and keeps no samples: nothing is ever rescanned
+struct RunningStats {
+    int64_t count = 0;
+    int64_t sum = 0;              // Exact, so average() equals a full recompute
+    double mean = 0.0;            // Welford mean
+    double m2 = 0.0;              // Sum of squared deviations from mean
+    int min = 0;
+
+    void push(int time)
+    {
+        ++count;
+        sum += time;
+        const double delta = time - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (time - mean);
+        min = (count == 1) ? time : std::min(min, time);
+    }
+
+    double average() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+    double variance() const { return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0; }
+};
+
+// Median and MAD of the newest WINDOW samples
+// The window is kept sorted, so each push is one binary search plus a
+// short memmove and the median is a lookup; nothing older is revisited
+struct RollingMedian {
+    static constexpr size_t WINDOW = 99;
+
+    std::vector<int32_t> sorted;                // Window, ascending
+    std::array<int32_t, WINDOW> arrival{};      // Window in push order, for eviction
+    size_t head = 0;                            // Oldest sample once the window is full
+
+    size_t size() const { return sorted.size(); }
+
+    void push(int32_t value)
+    {
+        if (sorted.size() == WINDOW)
+            sorted.erase(std::lower_bound(sorted.begin(), sorted.end(), arrival[head]));
+
+        arrival[head] = value;
+        head = (head + 1) % WINDOW;
+        sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), value), value);
+    }
+
+    double median() const
+    {
+        const size_t n = sorted.size();
+        if (n == 0)
+            return 0.0;
+        return (n % 2) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+    }
+
+    // Deviations from the median grow outwards on both sides of it, so the
+    // smallest ones come from merging the two halves walking away from the middle
+    double mad() const
+    {
+        const size_t n = sorted.size();
+        if (n == 0)
+            return 0.0;
+
+        const double m = median();
+        size_t right = n / 2;             // First sample >= the median side
+        size_t left = right;              // One past the last sample on the low side
+        const size_t want = n / 2;        // Index of the upper middle deviation
+
+        double prev = 0.0, cur = 0.0;
+        for (size_t k = 0; k <= want; ++k)
+        {
+            const double dl = (left > 0) ? m - sorted[left - 1] : -1.0;
+            const double dr = (right < n) ? sorted[right] - m : -1.0;
+
+            prev = cur;
+            if (dr < 0.0 || (dl >= 0.0 && dl < dr))
+            {
+                cur = dl;
+                --left;
+            }
+            else
+            {
+                cur = dr;
+                ++right;
+            }
+        }
+        return (n % 2) ? cur : (prev + cur) / 2.0;
+    }
+};
+
+// Why a time was left out of a room's stats
+// Ordered like the reason texts sort, so records compare without strings
+enum class OutlierReason : uint8_t {
+    TooShort,       // "<20s"
+    AboveMax,       // "above max"
+    BelowMin        // "below min"
+};
+
+constexpr std::array<std::string_view, 3> OUTLIER_REASON_TEXT = { "<20s", "above max", "below min" };
+
+inline std::string_view outlierReasonText(OutlierReason reason)
+{
+    return OUTLIER_REASON_TEXT[static_cast<size_t>(reason)];
+}
+
+// One discarded time; room and reason are ids, so nothing is copied but 12 bytes
+struct OutlierRecord {
+    int32_t kc;
+    int32_t time;
+    Room room;
+    OutlierReason reason;
+
+    std::string_view roomName() const { return ROOM_NAMES[roomIndex(room)]; }
+};
+static_assert(sizeof(OutlierRecord) == 12, "OutlierRecord should stay 12 bytes");
+
+// Newest kc first; ties by room name, time and reason text, all descending
+// (the order a reverse sort of (kc, name, time, reason) tuples gave)
+inline bool outlierBefore(const OutlierRecord& a, const OutlierRecord& b)
+{
+    if (a.kc != b.kc)
+        return a.kc > b.kc;
+    const uint8_t ra = ROOM_NAME_RANK[roomIndex(a.room)];
+    const uint8_t rb = ROOM_NAME_RANK[roomIndex(b.room)];
+    if (ra != rb)
+        return ra > rb;
+    if (a.time != b.time)
+        return a.time > b.time;
+    return a.reason > b.reason;
+}
 
 // Aggregated statistics for a single room or phase across many raids
 struct Stats {
-    struct Entry {
-        int kc;
-        int time;
-    };
-
-    std::vector<Entry> entries;   // All valid samples
-    std::vector<std::tuple<int, std::string, int, std::string>> discarded;
-    // ^ Outliers removed from analysis
+    RunningStats running;         // All valid samples, streamed
+    QuantileSketch quantiles;     // Same samples, for percentiles
+    RollingMedian recent;         // Recent times, for OutlierMode::Adaptive
+    std::vector<OutlierRecord> discarded;   // Outliers removed from analysis, reverse outlierBefore order (see addDiscarded)
 
     double avg = 0.0;             // Average value across valid samples
     int fastest = 0;              // Best (minimum) observed value
     int validCount = 0;           // Number of valid samples
+
+    // Adds a valid sample and re-derives the fields above
+    void push(int time)
+    {
+        running.push(time);
+        quantiles.push(time);
+        avg = running.average();
+        fastest = running.min;
+        validCount = static_cast<int>(running.count);
+    }
+
+    // Keeps discarded sorted oldest first; raids arrive in kc order, so this
+    // is an append unless the log itself is out of order
+    void addDiscarded(const OutlierRecord& record)
+    {
+        auto at = std::upper_bound(discarded.begin(), discarded.end(), record,
+            [](const OutlierRecord& a, const OutlierRecord& b) { return outlierBefore(b, a); });
+        discarded.insert(at, record);
+    }
 };
 
+// Every room's discarded log in outlierBefore order, read in place
+// Each log is already sorted, so forEach is a merge over their tails
+// (a few rooms at most); it refers to the Stats, which must outlive it
+struct DiscardedOutliers
+{
+    struct Run {
+        const OutlierRecord* begin;
+        const OutlierRecord* end;       // Next record is end[-1]
+    };
+
+    std::vector<Run> runs;              // Rooms with at least one record
+    size_t total = 0;
 
-const std::vector<std::string> PREP_ROOMS = {
-    "Tekton", "Crabs", "Ice demon", "Shamans", "Vanguards", "Thieving",
-    "Vespula", "Tightrope", "Guardians", "Vasa", "Mystics", "Muttadiles"
+    size_t size() const { return total; }
+    bool empty() const { return total == 0; }
+
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        std::vector<Run> left = runs;
+        while (!left.empty())
+        {
+            size_t next = 0;
+            for (size_t i = 1; i < left.size(); ++i)
+                if (outlierBefore(left[i].end[-1], left[next].end[-1]))
+                    next = i;
+
+            f(*--left[next].end);
+            if (left[next].end == left[next].begin)
+                left.erase(left.begin() + static_cast<std::ptrdiff_t>(next));
+        }
+    }
 };
 
-inline bool isPrepRoom(const std::string& room)
+
+// Room names as strings for the map-keyed stats, straight from COX_ROOMS
+inline std::vector<std::string> roomNames(size_t begin, size_t end)
 {
-    return std::find(PREP_ROOMS.begin(), PREP_ROOMS.end(), room) != PREP_ROOMS.end();
+    std::vector<std::string> names;
+    for (size_t i = begin; i < end; ++i)
+        names.emplace_back(ROOM_NAMES[i]);
+    return names;
 }
 
-const std::map<std::string, unsigned int> ROOM_REFERENCE_FOR_OUTLIERS = {
-    {"Tekton", 30},
-    {"Crabs", 45},
-    {"Ice demon", 90},
-    {"Shamans", 27},
-    {"Vanguards", 60},
-    {"Thieving", 45},
-    {"Vespula", 15},
-    {"Tightrope", 25},
-    {"Guardians", 35},
-    {"Vasa", 30},
-    {"Mystics", 30},
-    {"Muttadiles", 45},
-    {"Between room time", 20}
-};
-
-const std::map<std::string, unsigned int> ROOM_MAX_REFERENCE = {
-    {"Tekton",              240},
-    {"Crabs",               240},
-    {"Ice demon",           240},
-    {"Shamans",             240},
-    {"Vanguards",           240},
-    {"Thieving",            240},
-    {"Vespula",             240},
-    {"Tightrope",           240},
-    {"Guardians",           240},
-    {"Vasa",                240},
-    {"Mystics",             240},
-    {"Muttadiles",          240},
-    {"Between room time",   600}
-};
-
-const std::vector<std::string> DISPLAY_ORDER = {
-    "Tekton", "Crabs", "Ice demon", "Shamans", "Vanguards", "Thieving",
-    "Vespula", "Tightrope", "Guardians", "Vasa", "Mystics", "Muttadiles",
-    "Pre-Olm",
-    "Olm mage hand phase 1", "Olm phase 1", "Olm mage hand phase 2",
-    "Olm phase 2", "Olm phase 3", "Olm head",
-    "Olm",
-    "Raid Completed",
-    "Between room time",
-	"Total Points",
-    "PPH"
-};
+const std::vector<std::string> PREP_ROOMS = roomNames(0, PREP_ROOM_COUNT);
+
+const std::vector<std::string> DISPLAY_ORDER = roomNames(0, DISPLAY_ROOM_COUNT);
+
+inline bool isPrepRoom(const std::string& room)
+{
+    return isPrepRoom(roomFromName(room));
+}
 
 // Values prepared for table output (points or PPH)
 struct PointsToPrint {
@@ -123,4 +315,27 @@ struct RoomPPHResult
     std::string room;
     int avgPPH;
     int raids;
-};
\ No newline at end of file
+};
+
+// Spread of one room's valid times
+struct RoomPercentiles
+{
+    std::string room;
+    int p10;
+    int p50;
+    int p90;
+    int raids;
+    bool exact;      // false once the sketch has compacted
+};
+
+// One player's row in the --compare leaderboard (completion times in seconds)
+struct LeaderboardEntry
+{
+    std::string user;
+    int raids = 0;
+    int best = 0;
+    double avg = 0.0;
+    int median = 0;
+    double preOlm = 0.0;
+    double olm = 0.0;
+};